@@ -6,12 +6,18 @@
 
 #include "application.hpp"
 #include "model.hpp"
+#include "mesh_cache.hpp"
 #include "structs.hpp"
 #include "node.hpp"
 #include "geometry_node.hpp"
+#include "instanced_geometry_node.hpp"
 #include "scene_graph.hpp"
 #include "planet.hpp"
 #include "shader_attrib.hpp"
+#include "render_queue.hpp"
+#include "texture_registry.hpp"
+#include "texture_streamer.hpp"
+#include "point_light_node.hpp"
 
 // gpu representation of model
 class ApplicationSolar : public Application {
@@ -33,7 +39,7 @@ public:
   void initializeSceneGraph();
   void initializePlanets();
 
-  void bindObjModel(model_object &bound, model &model);
+  void bindObjModel(model_object &bound, MappedMesh const& mesh);
   void bindModel(
       model_object &bound,
       std::vector<GLfloat> const& modelData,
@@ -46,16 +52,24 @@ protected:
   void initializeGeometry();
   // update uniform values
   void uploadUniforms() override;
+  void uploadSamplers();
+  void uploadFrameUniforms();
 
   void rotatePlanets(double dTime);
+  // print the counters of the render queue
+  void printRenderStats() const;
   // move view based on key presses
   void moveView(double dTime);
   //
   bool isKeyDown(int key) const;
 
-  texture_object loadTexture(std::string const& fileName);
+  // textures are decoded in the background and show the placeholder color until they are uploaded
+  texture_object loadTexture(std::string const& fileName, std::array<std::uint8_t, 4> const& placeholder = {{128, 128, 128, 255}});
+  // array texture with one file per layer, all resized to the given size
+  texture_object loadTextureArray(std::vector<std::string> const& fileNames, std::size_t width, std::size_t height);
 
   void initializeFrameBuffers();
+  void initializeUniformBuffers();
   void updateBufferTextures(int width, int height);
   void enableMsaaBuffer();
   void copyMsaaBuffer();
@@ -73,6 +87,9 @@ protected:
   unsigned int depth_texture;
   unsigned int light_texture;
 
+  // uniform buffer with the per frame data of all shaders
+  unsigned int frame_data_ubo;
+
   unsigned int post_process_fbo;
   unsigned int pp_color_texture;
   unsigned int pp_depth_texture;
@@ -93,7 +110,19 @@ protected:
   std::set<int> m_keys_down;
   std::map<std::string, Planet> m_planetData;
   std::shared_ptr<CameraNode> m_cam;
+  // light source of the planet shaders
+  std::shared_ptr<PointLightNode> m_sun;
   std::shared_ptr<GeometryNode> skybox;
+  // asteroid belt, its instance buffer is freed with the other buffers of the application
+  std::shared_ptr<InstancedGeometryNode> m_asteroids;
+  // draw items of the scene graph, kept to reuse its storage every frame
+  RenderQueue m_renderQueue;
+  // decodes the textures of the scene, the finished ones are uploaded at the start of each frame
+  TextureStreamer m_textureStreamer;
+  // shares the textures of files used by several nodes, deletes them when the application is destroyed
+  TextureRegistry m_textureRegistry;
+  // framebuffer height in pixels, the screen size of level of detail errors depends on it
+  unsigned m_viewportHeight;
 
   //last time render was called
   double m_last_frame;
@@ -4,6 +4,8 @@
 #include "utils.hpp"
 #include "shader_loader.hpp"
 #include "model_loader.hpp"
+#include "mesh_cache.hpp"
+#include "procedural_mesh.hpp"
 #include "texture_loader.hpp"
 
 #include <glbinding/gl/gl.h>
@@ -26,9 +28,26 @@ using namespace gl;
 #include <string>
 #include <fstream>
 #include "geometry_node.hpp"
+#include "instanced_geometry_node.hpp"
 #include "camera_node.hpp"
 #include "shader_attrib.hpp"
 #include "point_light_node.hpp"
+#include "frame_data.hpp"
+
+// asteroids in the belt between mars and jupiter
+static const int ASTEROID_COUNT = 2000;
+// tessellation of the planet spheres, the levels of detail halve it down to procedural_mesh::MIN_SPHERE_RINGS
+static const std::size_t PLANET_RINGS = 32;
+static const std::size_t PLANET_SEGMENTS = 64;
+static const std::size_t PLANET_LOD_COUNT = 4;
+// vertices on the circle of orbits and saturn's rings
+static const std::size_t ORBIT_SEGMENTS = 200;
+// size of the layers of the planet texture array, most planet textures have it already
+static const std::size_t PLANET_TEXTURE_WIDTH = 1024;
+static const std::size_t PLANET_TEXTURE_HEIGHT = 512;
+// saturn's ring is a thin gradient, it keeps the size of its image in a texture of its own
+static const std::size_t RING_TEXTURE_WIDTH = 915;
+static const std::size_t RING_TEXTURE_HEIGHT = 64;
 
 ApplicationSolar::ApplicationSolar(std::string const &resource_path)
     : Application{resource_path},
@@ -39,12 +58,19 @@ ApplicationSolar::ApplicationSolar(std::string const &resource_path)
       m_keys_down{},
       m_planetData{},
       m_cam{nullptr},
+      m_sun{nullptr},
+      m_asteroids{nullptr},
+      m_renderQueue{},
+      m_textureStreamer{},
+      m_textureRegistry{m_textureStreamer},
+      m_viewportHeight{initial_resolution[1]},
       m_last_frame{0} {
   initializeKeyMap();
   initializePlanets();
   initializeGeometry();
   initializeShaderPrograms();
   initializeFrameBuffers();
+  initializeUniformBuffers();
   initializeSceneGraph();
 
   noiseTex = loadTexture(m_resource_path + "textures/RGBA_noise_small_shadertoy.png");
@@ -66,57 +92,54 @@ ApplicationSolar::~ApplicationSolar() {
   glDeleteBuffers(1, &skybox_object.vertex_BO);
   glDeleteBuffers(1, &skybox_object.element_BO);
   glDeleteVertexArrays(1, &skybox_object.vertex_AO);
+
+  glDeleteBuffers(1, &frame_data_ubo);
+  // the node lives in the static scene graph, which is only destroyed after the context
+  m_asteroids->releaseBuffers();
 }
 
 void ApplicationSolar::render() {
   double time = glfwGetTime();
   //calculate delta time to last render for FPS independent planet speed
   double dTime = time - m_last_frame;
+  //replace the placeholders of textures decoded since the last frame
+  m_textureStreamer.uploadFinished();
 
   rotatePlanets(dTime);
   moveView(dTime);
 
-  glm::fmat4 view_transform = m_cam->getViewTransform();
-  uploadUniforms();
+  //nodes sort and select their level of detail by camera space depth, the camera node holds the inverse view matrix
+  glm::fmat4 view_transform = glm::inverse(m_cam->getViewTransform());
+  uploadFrameUniforms();
   enableMsaaBuffer();
 
-  glUseProgram(m_shaders.at("skybox").handle);
+  //skybox clears the depth buffer after drawing, so it is drawn before everything else
   skybox->render(m_shaders, view_transform);
-  SceneGraph::get().getRoot()->render(m_shaders, view_transform);
+  //collect all geometry first and draw it sorted by state
+  m_renderQueue.clear();
+  //pixels per unit at distance one, the projection scales y by the cotangent of half the fov
+  m_renderQueue.setLodScale(m_cam->getProjectionMatrix()[1][1] * 0.5f * float(m_viewportHeight));
+  SceneGraph::get().getRoot()->collect(m_renderQueue, m_shaders, view_transform);
+  m_renderQueue.submit();
 
   renderFrameBuffer();
   m_last_frame = time;
 }
 
+//print draw calls and state changes of the last frame
+void ApplicationSolar::printRenderStats() const {
+  RenderStats const& stats = m_renderQueue.getStats();
+  std::cout << "draw calls: " << stats.drawCalls
+            << ", program binds: " << stats.programBinds << " (" << stats.programBindsAvoided << " avoided)"
+            << ", vertex array binds: " << stats.vertexArrayBinds << " (" << stats.vertexArrayBindsAvoided << " avoided)"
+            << ", texture binds: " << stats.textureBinds << " (" << stats.textureBindsAvoided << " avoided)" << std::endl;
+  std::cout << "textures: " << m_textureRegistry.getTextureCount()
+            << ", texture memory: " << m_textureRegistry.getMemoryUsage() / 1024 << " KB" << std::endl;
+}
+
 void ApplicationSolar::rotatePlanets(double dTime) {
-  //run this lambda function for each node of the scene graph
-  SceneGraph::get().getRoot()->iterate([this, &dTime] (std::shared_ptr<Node> node) -> void {
-    std::string nodeName = node->getName();
-    //find out which planet this node is
-    std::string planetName = nodeName.substr(0, nodeName.find('-'));
-    //try to find planet data for the planet (sun does not get rotated)
-    auto iter = m_planetData.find(planetName);
-
-    if (iter == m_planetData.end()) {
-      return;
-    }
-    Planet planet = iter->second;
-    float angle = 0;
-
-    if (nodeName.find("hold") != std::string::npos) {
-      //calculate how much planet orbited since last frame
-      angle = (float) dTime / planet.orbitPeriod * 360;
-    } else if (nodeName.find("geom") != std::string::npos){
-      //calculate how much planet rotated around own axis
-      angle = (float) dTime / planet.rotationPeriod * 360;
-    } else {
-      return;
-    }
-    //create transformation matrix containing this rotation
-    glm::fmat4 rotation = glm::rotate(glm::fmat4(1), glm::radians(angle), glm::fvec3(0, 1, 0));
-    //apply rotation to local transform of planet
-    node->setLocalTransform(rotation * node->getLocalTransform());
-  });
+  //advance the orbit and spin components of all planets and update the scene graph
+  SceneGraph::get().update(dTime);
 }
 
 //makes rendering go to framebuffer and not to screen
@@ -156,17 +179,12 @@ void ApplicationSolar::renderFrameBuffer() {
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
   glDisable(GL_DEPTH_TEST);
 
-  // Use the framebuffer shader program
-  glUseProgram(m_shaders.at("post_process").handle);
+  // Use the framebuffer shader program, its samplers are set by uploadSamplers
+  shader_program const& postShader = m_shaders.at("post_process");
+  glUseProgram(postShader.handle);
   // Bind the vertex array object for rendering the screen quad
   glBindVertexArray(screen_quad_object.vertex_AO);
 
-  // Bind the post-processing texture to shader
-  auto programID = m_shaders.at("post_process").handle;
-  glUniform1i(glGetUniformLocation(programID, "ColorTex"), 0);
-  glUniform1i(glGetUniformLocation(programID, "DepthTex"), 1);
-  glUniform1i(glGetUniformLocation(programID, "LightTex"), 2);
-
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, pp_color_texture);
   glActiveTexture(GL_TEXTURE1);
@@ -177,41 +195,53 @@ void ApplicationSolar::renderFrameBuffer() {
   //upload noise texture for post-processing effects (theoretically only needed once)
   glActiveTexture(GL_TEXTURE3);
   glBindTexture(GL_TEXTURE_2D, noiseTex.handle);
-  glUniform1i(m_shaders.at("post_process").u_locs.at("NoiseTex"), 3);
-  glUniform1f(m_shaders.at("post_process").u_locs.at("Time"), glfwGetTime());
 
   // Render the quad with the post-processing texture over the entire screen
   glDrawArrays(screen_quad_object.draw_mode, 0, screen_quad_object.num_elements);
 }
 
 // upload uniform values to new locations
+//called after the shaders were linked
 void ApplicationSolar::uploadUniforms() {
-  std::shared_ptr<PointLightNode> sun = std::dynamic_pointer_cast<PointLightNode>(SceneGraph::get().getRoot()->getChild("sun-light"));
-  glm::fvec3 sunPos = glm::fvec3(sun->getWorldTransform()[3]);
-  glm::fvec3 sunColor = sun->getColor() * sun->getIntensity();
-  glm::fvec3 ambient = glm::fvec3(.5f);
-
-  glUseProgram(m_shaders.at("planet").handle);
-  glUniform3fv(m_shaders.at("planet").u_locs.at("AmbientLight"), 1, glm::value_ptr(ambient));
-  glUniform3fv(m_shaders.at("planet").u_locs.at("PointLightPos"), 1, glm::value_ptr(sunPos));
-  glUniform3fv(m_shaders.at("planet").u_locs.at("PointLightColor"), 1, glm::value_ptr(sunColor));
-  glUniform3fv(m_shaders.at("planet").u_locs.at("CameraPos"), 1, glm::value_ptr(m_cam->getPos()));
-
-  glUseProgram(m_shaders.at("skybox").handle);
-  glUniform3fv(m_shaders.at("skybox").u_locs.at("CameraPos"), 1, glm::value_ptr(m_cam->getPos()));
-
-  glm::fmat4 projection_transform = m_cam->getProjectionMatrix();
-  glm::fmat4 view_transform = m_cam->getViewTransform();
-
-  for (auto& iter : m_shaders) {
-    // bind shader to which to upload uniforms
-    glUseProgram(iter.second.handle);
-    // vertices are transformed in camera space, so camera transform must be inverted
-    // upload matrix to gpu
-    glUniformMatrix4fv(iter.second.u_locs.at("ViewMatrix"), 1, GL_FALSE, glm::value_ptr(glm::inverse(view_transform)));
-    // upload matrix to gpu
-    glUniformMatrix4fv(iter.second.u_locs.at("ProjectionMatrix"), 1, GL_FALSE, glm::value_ptr(projection_transform));
-  }
+  uploadSamplers();
+  uploadFrameUniforms();
+}
+
+//light and camera data changing every frame, uploaded once into the buffer shared by all shaders
+void ApplicationSolar::uploadFrameUniforms() {
+  frame_data frame{};
+  // vertices are transformed in camera space, so camera transform must be inverted
+  frame.view_matrix = glm::inverse(m_cam->getViewTransform());
+  frame.projection_matrix = m_cam->getProjectionMatrix();
+  frame.camera_pos = m_cam->getPos();
+  frame.time = float(glfwGetTime());
+  frame.point_light_pos = glm::fvec3(m_sun->getWorldTransform()[3]);
+  frame.point_light_color = m_sun->getColor() * m_sun->getIntensity();
+  frame.ambient_light = glm::fvec3(.5f);
+
+  glBindBuffer(GL_UNIFORM_BUFFER, frame_data_ubo);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frame_data), &frame);
+}
+
+//samplers read fixed texture units, so they only have to be set after linking
+void ApplicationSolar::uploadSamplers() {
+  shader_program const& planetShader = m_shaders.at("planet");
+  glUseProgram(planetShader.handle);
+  glUniform1i(planetShader.u_locs.at("Tex"), 0);
+  glUniform1i(planetShader.u_locs.at("NormalMap"), 1);
+
+  shader_program const& instancedShader = m_shaders.at("planet_instanced");
+  glUseProgram(instancedShader.handle);
+  glUniform1i(instancedShader.u_locs.at("Tex"), 0);
+  //unused, but samplers of different types must not share the unit of the array
+  glUniform1i(instancedShader.u_locs.at("NormalMap"), 1);
+
+  shader_program const& postShader = m_shaders.at("post_process");
+  glUseProgram(postShader.handle);
+  glUniform1i(postShader.u_locs.at("ColorTex"), 0);
+  glUniform1i(postShader.u_locs.at("DepthTex"), 1);
+  glUniform1i(postShader.u_locs.at("LightTex"), 2);
+  glUniform1i(postShader.u_locs.at("NoiseTex"), 3);
 }
 
 ///////////////////////////// intialisation functions /////////////////////////
@@ -221,6 +251,9 @@ void ApplicationSolar::initializeShaderPrograms() {
   m_shaders.emplace("planet", shader_program{{
                                                      {GL_VERTEX_SHADER, m_resource_path + "shaders/simple.vert"},
                                                      {GL_FRAGMENT_SHADER, m_resource_path + "shaders/simple.frag"}}});
+  m_shaders.emplace("planet_instanced", shader_program{{
+                                                     {GL_VERTEX_SHADER, m_resource_path + "shaders/simple_instanced.vert"},
+                                                     {GL_FRAGMENT_SHADER, m_resource_path + "shaders/simple.frag"}}});
   m_shaders.emplace("wirenet", shader_program{{
                                                       {GL_VERTEX_SHADER, m_resource_path + "shaders/vao.vert"},
                                                       {GL_FRAGMENT_SHADER, m_resource_path + "shaders/vao.frag"}}});
@@ -233,39 +266,33 @@ void ApplicationSolar::initializeShaderPrograms() {
                                                            {GL_FRAGMENT_SHADER,
                                                             m_resource_path + "shaders/post_process.frag"}}});
 
-  // request uniform locations for shader program
+  // request uniform locations for shader program, camera and light come from the FrameData block
   m_shaders.at("planet").u_locs["NormalMatrix"] = -1;
   m_shaders.at("planet").u_locs["ModelMatrix"] = -1;
-  m_shaders.at("planet").u_locs["ViewMatrix"] = -1;
-  m_shaders.at("planet").u_locs["ProjectionMatrix"] = -1;
   m_shaders.at("planet").u_locs["Color"] = -1;
-  m_shaders.at("planet").u_locs["PointLightColor"] = -1;
-  m_shaders.at("planet").u_locs["PointLightPos"] = -1;
-  m_shaders.at("planet").u_locs["AmbientLight"] = -1;
-  m_shaders.at("planet").u_locs["CameraPos"] = -1;
   m_shaders.at("planet").u_locs["Tex"] = -1;
   m_shaders.at("planet").u_locs["NormalMap"] = -1;
   m_shaders.at("planet").u_locs["IsCelEnabled"] = -1;
   m_shaders.at("planet").u_locs["IsNormalMapEnabled"] = -1;
+  m_shaders.at("planet").u_locs["TexCoordTransform"] = -1;
+  m_shaders.at("planet").u_locs["TextureLayer"] = -1;
+
+  //model, normal matrix, color and texture layer are instance attributes
+  m_shaders.at("planet_instanced").u_locs["Tex"] = -1;
+  m_shaders.at("planet_instanced").u_locs["NormalMap"] = -1;
+  m_shaders.at("planet_instanced").u_locs["IsCelEnabled"] = -1;
+  m_shaders.at("planet_instanced").u_locs["TexCoordTransform"] = -1;
 
   //stars matrices
   m_shaders.at("wirenet").u_locs["ModelMatrix"] = -1;
-  m_shaders.at("wirenet").u_locs["ViewMatrix"] = -1;
-  m_shaders.at("wirenet").u_locs["ProjectionMatrix"] = -1;
 
   m_shaders.at("skybox").u_locs["ModelMatrix"] = -1;
-  m_shaders.at("skybox").u_locs["ViewMatrix"] = -1;
-  m_shaders.at("skybox").u_locs["ProjectionMatrix"] = -1;
   m_shaders.at("skybox").u_locs["Tex"] = -1;
-  m_shaders.at("skybox").u_locs["CameraPos"] = -1;
 
-  m_shaders.at("post_process").u_locs["ViewMatrix"] = -1;
-  m_shaders.at("post_process").u_locs["ProjectionMatrix"] = -1;
   m_shaders.at("post_process").u_locs["ColorTex"] = -1;
   m_shaders.at("post_process").u_locs["DepthTex"] = -1;
   m_shaders.at("post_process").u_locs["LightTex"] = -1;
   m_shaders.at("post_process").u_locs["NoiseTex"] = -1;
-  m_shaders.at("post_process").u_locs["Time"] = -1;
 
   for (auto const &pair: m_shader_key_map) {
     m_shaders.at("post_process").u_locs[pair.second] = -1;
@@ -273,6 +300,15 @@ void ApplicationSolar::initializeShaderPrograms() {
 }
 
 
+//create the buffer holding the FrameData block of all shaders
+void ApplicationSolar::initializeUniformBuffers() {
+  glGenBuffers(1, &frame_data_ubo);
+  glBindBuffer(GL_UNIFORM_BUFFER, frame_data_ubo);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(frame_data), NULL, GL_DYNAMIC_DRAW);
+  //the binding point stays attached, programs only have to reference it after linking
+  glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, frame_data_ubo);
+}
+
 void ApplicationSolar::initializeFrameBuffers() {
   //create framebuffer objects
   glGenFramebuffers(1, &msaa_fbo);
@@ -373,13 +409,14 @@ void ApplicationSolar::createTextureAttachment(
 
 // load models
 void ApplicationSolar::initializeGeometry() {
-  model planet_model = model_loader::obj(m_resource_path + "models/sphere.obj", model::NORMAL | model::TEXCOORD);
-  planet_object.draw_mode = GL_TRIANGLES;
-  bindObjModel(planet_object, planet_model);
+  //planets are unit spheres built in place, their levels of detail are coarser tessellations in the same buffers
+  model planet_model = procedural_mesh::sphere(PLANET_RINGS, PLANET_SEGMENTS, model::NORMAL | model::TEXCOORD | model::TANGENT | model::BITANGENT, PLANET_LOD_COUNT);
+  planet_object = utils::create_model_object(planet_model, GL_TRIANGLES, true);
 
-  model planet_model2 = model_loader::obj(m_resource_path + "models/sphere1.obj", model::NORMAL | model::TEXCOORD);
+  //obj files are parsed, welded, optimized, simplified and packed once, later starts map their binary cache
+  MappedMesh planet_mesh2 = mesh_cache::obj(m_resource_path + "models/sphere1.obj", model::NORMAL | model::TEXCOORD, model_loader::WELD_VERTICES | model_loader::OPTIMIZE | model_loader::PACK_VERTICES | model_loader::GENERATE_LODS);
   planet_object2.draw_mode = GL_TRIANGLES;
-  bindObjModel(planet_object2, planet_model2);
+  bindObjModel(planet_object2, planet_mesh2);
 
   //////////////// Stars ////////////////
 
@@ -406,157 +443,24 @@ void ApplicationSolar::initializeGeometry() {
 
   //////////////// Orbit ////////////////
 
-  float TWO_PI = 2 * glm::pi<float>();
-  int orbitVertCount = 200;
-
-  std::vector<GLfloat> orbitVerts{};
-  std::vector<GLuint> orbitIndices{};
-
-  for (int i = 0; i < orbitVertCount; ++i) {
-    //orbit vertex position xyz
-    orbitVerts.emplace_back(glm::cos(TWO_PI * i / orbitVertCount));
-    orbitVerts.emplace_back(0);
-    orbitVerts.emplace_back(glm::sin(TWO_PI * i / orbitVertCount));
-    //orbit color
-    orbitVerts.emplace_back(1);
-    orbitVerts.emplace_back(1);
-    orbitVerts.emplace_back(1);
-    //vertex index
-    orbitIndices.emplace_back(i);
-  }
-  orbit_object.draw_mode = GL_LINE_LOOP;
-  orbit_object.num_elements = orbitVertCount;
-  bindModel(orbit_object, orbitVerts, orbitIndices, std::vector<ShaderAttrib>{
-      ShaderAttrib{0, 3, 6, 0},
-      ShaderAttrib{1, 3, 6, 3}
-  });
+  orbit_object = utils::create_model_object(procedural_mesh::orbit(ORBIT_SEGMENTS), GL_LINE_LOOP);
+  //orbits have no color attribute, the wirenet shader reads the constant value instead
+  glVertexAttrib3f(1, 1.0f, 1.0f, 1.0f);
+
   //////////////// Saturn Rings ////////////////
 
-  std::vector<GLfloat> ringVerts{};
-  std::vector<GLuint> ringIndices{};
-  float ringsScale = 1.5f;
-
-  for (int i = 0; i <= orbitVertCount; ++i) {
-    float phi = TWO_PI * i / orbitVertCount;
-    //inner vertex
-    //xyz
-    ringVerts.emplace_back(glm::cos(phi));
-    ringVerts.emplace_back(0);
-    ringVerts.emplace_back(glm::sin(phi));
-    //normal
-    ringVerts.emplace_back(0);
-    ringVerts.emplace_back(1);
-    ringVerts.emplace_back(0);
-    //uv somehow off by a few pixels
-    ringVerts.emplace_back(0.1);
-    ringVerts.emplace_back(0.5);
-    //index
-    ringIndices.emplace_back(2 * i);
-
-    //outer vertex
-    ringVerts.emplace_back(glm::cos(phi) * ringsScale);
-    ringVerts.emplace_back(0);
-    ringVerts.emplace_back(glm::sin(phi) * ringsScale);
-    //normal
-    ringVerts.emplace_back(0);
-    ringVerts.emplace_back(1);
-    ringVerts.emplace_back(0);
-    //uv
-    ringVerts.emplace_back(0.9);
-    ringVerts.emplace_back(0.5);
-    //index
-    ringIndices.emplace_back(2 * i + 1);
-  }
-  saturn_rings.draw_mode = GL_TRIANGLE_STRIP;
-  saturn_rings.num_elements = (GLsizei) ringIndices.size();
-  bindModel(saturn_rings, ringVerts, ringIndices, std::vector<ShaderAttrib>{
-      ShaderAttrib{0, 3, 8, 0},
-      ShaderAttrib{1, 3, 8, 3},
-      ShaderAttrib{2, 2, 8, 6}
-  });
+  saturn_rings = utils::create_model_object(procedural_mesh::ring(ORBIT_SEGMENTS, 1.0f, 1.5f), GL_TRIANGLE_STRIP);
+  //sample the middle row of the ring texture and keep away from its edges
+  saturn_rings.texcoord_transform = {{0.1f, 0.5f, 0.8f, 0.0f}};
 
   //////////////// Skybox ////////////////
 
-  //make 8 cube vertices
-  std::vector<GLfloat> skyboxVerts = {
-      //-Z back face
-      -1.0f,  1.0f, -1.0f, //0
-       1.0f,  1.0f, -1.0f, //1
-      -1.0f, -1.0f, -1.0f, //2
-       1.0f, -1.0f, -1.0f, //3
-       //+Z front face
-      -1.0f,  1.0f, 1.0f, //4
-       1.0f,  1.0f, 1.0f, //5
-      -1.0f, -1.0f, 1.0f, //6
-       1.0f, -1.0f, 1.0f, //7
-  };
-
-  //triangulate cube faces
-  //order and rotation do not seem to effect image rotation :shrug:
-  std::vector<GLuint> skyboxIndices = {
-      // +X right face
-      1, 5, 3,
-      3, 5, 7,
-      // -X left face
-      4, 0, 6,
-      6, 0, 2,
-      // +Y top face
-      4, 5, 0,
-      0, 5, 1,
-      // -Y down face
-      6, 7, 2,
-      2, 7, 3,
-      // +Z front face
-      5, 4, 7,
-      7, 4, 6,
-      // -Z back face
-      0, 1, 2,
-      2, 1, 3,
-  };
-
-  skybox_object.draw_mode = GL_TRIANGLES;
-  skybox_object.num_elements = (GLsizei) skyboxIndices.size();
-  bindModel(skybox_object, skyboxVerts, skyboxIndices, std::vector<ShaderAttrib>{
-      ShaderAttrib{0, 3, 0, 0}
-  });
+  skybox_object = utils::create_model_object(procedural_mesh::cube(), GL_TRIANGLES);
 }
 
-void ApplicationSolar::bindObjModel(model_object &bound, model &model) {
-// generate vertex array object
-  glGenVertexArrays(1, &bound.vertex_AO);
-  // bind the array for attaching buffers
-  glBindVertexArray(bound.vertex_AO);
-
-  // generate generic buffer
-  glGenBuffers(1, &bound.vertex_BO);
-  // bind this as a vertex array buffer containing all attributes
-  glBindBuffer(GL_ARRAY_BUFFER, bound.vertex_BO);
-  // configure currently bound array buffer
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * model.data.size(), model.data.data(), GL_STATIC_DRAW);
-
-  // activate first attribute on gpu
-  glEnableVertexAttribArray(0);
-  // first attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(0, model::POSITION.components, model::POSITION.type, GL_FALSE, model.vertex_bytes, model.offsets[model::POSITION]);
-  // activate second attribute on gpu
-  glEnableVertexAttribArray(1);
-  // second attribute is 3 floats with no offset & stride
-  glVertexAttribPointer(1, model::NORMAL.components, model::NORMAL.type, GL_FALSE, model.vertex_bytes, model.offsets[model::NORMAL]);
-
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(2, model::TEXCOORD.components, model::TEXCOORD.type, GL_FALSE, model.vertex_bytes, model.offsets[model::TEXCOORD]);
-
-  // generate generic buffer
-  glGenBuffers(1, &bound.element_BO);
-  // bind this as a vertex array buffer containing all attributes
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bound.element_BO);
-  // configure currently bound array buffer
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, model::INDEX.size * model.indices.size(), model.indices.data(), GL_STATIC_DRAW);
-
-  // store type of primitive to draw
-  bound.draw_mode = bound.draw_mode;
-  // transfer number of indices to model object
-  bound.num_elements = GLsizei(model.indices.size());
+void ApplicationSolar::bindObjModel(model_object &bound, MappedMesh const& mesh) {
+  // position, normal, texture coordinates, tangent and bitangent are bound to locations 0 to 4
+  bound = utils::create_model_object(mesh, bound.draw_mode);
 }
 
 void ApplicationSolar::bindModel(
@@ -595,21 +499,24 @@ void ApplicationSolar::bindModel(
 
 //define planet dimensions
 void ApplicationSolar::initializePlanets() {
-  // Create the planet data with name, diameter, orbit radius and orbital period in seconds
-  m_planetData.emplace("mercury", Planet{.2f, 6, 4, 1, glm::fvec3(0.73, 0.73, 0.73)});
-  m_planetData.emplace("venus", Planet{.3f, 7, 8, 1.5, glm::fvec3(0.96, 0.64, 0.09)});
-  m_planetData.emplace("earth", Planet{.5, 9, 15, 2, glm::fvec3(0.02, 0.36, 1.00)});
-  m_planetData.emplace("mars", Planet{.4f, 11, 17, 1.5, glm::fvec3(0.79, 0.05, 0.05)});
-  m_planetData.emplace("jupiter", Planet{2, 14.5f, 20, 5, glm::fvec3(1.00, 0.28, 0.08)});
-  m_planetData.emplace("saturn", Planet{1.8f, 19, 30, 4, glm::fvec3(0.89, 0.67, 0.30)});
-  m_planetData.emplace("uranus", Planet{1, 22, 45, 3, glm::fvec3(0.51, 0.74, 0.41)});
-  m_planetData.emplace("neptune", Planet{.9f, 24, 60, 3, glm::fvec3(0.09, 0.14, 0.92)});
-  m_planetData.emplace("moon", Planet{.2f, 1, 5, 4, glm::fvec3(.5f)});
-  m_planetData.emplace("sun", Planet{5, 0, 120, 100, glm::fvec3(10000)});
+  // Create the planet data with name, diameter, orbit radius, orbital period and rotation period in seconds,
+  // color, orbit eccentricity and a random start angle on the orbit
+  float TWO_PI = 2 * glm::pi<float>();
+  m_planetData.emplace("mercury", Planet{.2f, 6, 4, 1, glm::fvec3(0.73, 0.73, 0.73), .2f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("venus", Planet{.3f, 7, 8, 1.5, glm::fvec3(0.96, 0.64, 0.09), .01f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("earth", Planet{.5, 9, 15, 2, glm::fvec3(0.02, 0.36, 1.00), .02f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("mars", Planet{.4f, 11, 17, 1.5, glm::fvec3(0.79, 0.05, 0.05), .09f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("jupiter", Planet{2, 14.5f, 20, 5, glm::fvec3(1.00, 0.28, 0.08), .05f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("saturn", Planet{1.8f, 19, 30, 4, glm::fvec3(0.89, 0.67, 0.30), .06f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("uranus", Planet{1, 22, 45, 3, glm::fvec3(0.51, 0.74, 0.41), .05f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("neptune", Planet{.9f, 24, 60, 3, glm::fvec3(0.09, 0.14, 0.92), .01f, glm::linearRand(0.f, TWO_PI)});
+  m_planetData.emplace("moon", Planet{.2f, 1, 5, 4, glm::fvec3(.5f), .05f, 0});
+  m_planetData.emplace("sun", Planet{5, 0, 120, 100, glm::fvec3(10000), 0, 0});
 }
 
 void ApplicationSolar::initializeSceneGraph() {
   std::string planetsTexPath = m_resource_path + "textures/planets/";
+  float TWO_PI = 2 * glm::pi<float>();
 
   // create camera
   m_cam = std::make_shared<CameraNode>("camera", utils::calculate_projection_matrix(initial_aspect_ratio));
@@ -618,6 +525,18 @@ void ApplicationSolar::initializeSceneGraph() {
 
   // Create the sun GeometryNode
   std::shared_ptr<Node> root = SceneGraph::get().getRoot();
+  AnimationSystem& animations = SceneGraph::get().getAnimations();
+
+  // images of all planets and the moon share one array texture, so drawing them never changes the binding
+  std::vector<std::string> layerFiles;
+  std::map<std::string, GLint> textureLayers;
+  for (auto const& pair : m_planetData) {
+    textureLayers[pair.first] = GLint(layerFiles.size());
+    layerFiles.push_back(planetsTexPath + pair.first + ".jpg");
+  }
+  texture_object planetTextures = loadTextureArray(layerFiles, PLANET_TEXTURE_WIDTH, PLANET_TEXTURE_HEIGHT);
+  // an array of one layer, so the rings are drawn by the same program as the planets
+  texture_object ringTexture = loadTextureArray({planetsTexPath + "saturn_ring.jpg"}, RING_TEXTURE_WIDTH, RING_TEXTURE_HEIGHT);
 
   // Add the child GeometryNodes to the sun GeometryNode
   for (auto const& pair : m_planetData) {
@@ -631,23 +550,25 @@ void ApplicationSolar::initializeSceneGraph() {
     std::shared_ptr<Node> planetHolder = std::make_shared<Node>(name + "-hold");
     std::shared_ptr<GeometryNode> planetGeometry = std::make_shared<GeometryNode>(name + "-geom", planet_object, planet.color, "planet");
 
-    glm::fmat4 transform = glm::fmat4(1);
-    //give each planet a random rotation at start
-    transform = glm::rotate(transform, glm::linearRand(0.f, 2 * glm::pi<float>()), glm::fvec3(0, 1, 0));
-    //translate each planet away from the sun
-    transform = glm::translate(transform, glm::vec3(planet.orbitRadius, 0, 0));
-    planetHolder->setLocalTransform(transform);
+    //translate each planet away from the sun to its start position
+    planetHolder->setLocalTransform(glm::translate(glm::mat4(1), planet.orbitPosition(0)));
 
     //scale the geometry node to the defined size of the planet
-    planetGeometry->setLocalTransform(glm::scale(glm::mat4(1), glm::vec3(planet.diameter)));
-    planetOrbit->setLocalTransform(glm::scale(glm::mat4(1), glm::vec3(planet.orbitRadius)));
+    glm::fmat4 geometryScale = glm::scale(glm::mat4(1), glm::vec3(planet.diameter));
+    planetGeometry->setLocalTransform(geometryScale);
+    //stretch orbit circle to the orbit ellipse
+    planetOrbit->setLocalTransform(planet.orbitEllipse());
 
-    planetGeometry->setTexture(loadTexture(planetsTexPath + name + ".jpg"));
+    planetGeometry->setTexture(planetTextures, textureLayers.at(name));
 
     if (name == "earth") {
-      planetGeometry->setNormalMap(loadTexture(planetsTexPath + "earth_normal.jpg"));
+      planetGeometry->setNormalMap(loadTexture(planetsTexPath + "earth_normal.jpg", {{128, 128, 255, 255}}));
     }
 
+    //let planet orbit around the sun and rotate around its own axis
+    animations.add(planetHolder, OrbitComponent{OrbitComponent::ORBIT, planet, glm::fmat4(1)});
+    animations.add(planetGeometry, OrbitComponent{OrbitComponent::SPIN, planet, geometryScale});
+
     //add planet to scene graph
     root->addChild(planetHolder);
     root->addChild(planetOrbit);
@@ -656,7 +577,7 @@ void ApplicationSolar::initializeSceneGraph() {
     if (name == "saturn") {
       std::shared_ptr<GeometryNode> rings = std::make_shared<GeometryNode>(name + "-rings", saturn_rings, planet.color, "planet");
       rings->setLocalTransform(glm::scale(glm::mat4(1), glm::vec3(0.5f * planet.diameter + 0.3)));
-      rings->setTexture(loadTexture(planetsTexPath + name + "_ring.jpg"));
+      rings->setTexture(ringTexture);
       planetGeometry->addChild(rings);
     }
   }
@@ -666,13 +587,14 @@ void ApplicationSolar::initializeSceneGraph() {
   root->addChild(stars);
 
   //create sun
-  std::shared_ptr<Node> sunLight = std::make_shared<PointLightNode>("sun-light", glm::fvec3(1), 1000);
+  m_sun = std::make_shared<PointLightNode>("sun-light", glm::fvec3(1), 1000);
   std::shared_ptr<GeometryNode> sunGeometry = std::make_shared<GeometryNode>("sun-geom", planet_object, m_planetData.at("sun").color, "planet");
   sunGeometry->setLocalTransform(glm::scale(glm::mat4(1), glm::vec3(5)));
-  sunGeometry->setTexture(loadTexture(planetsTexPath + "sun.jpg"));
+  sunGeometry->setTexture(planetTextures, textureLayers.at("sun"));
 
-  root->addChild(sunLight);
-  sunLight->addChild(sunGeometry);
+  root->addChild(m_sun);
+  m_sun->addChild(sunGeometry);
+  animations.add(sunGeometry, OrbitComponent{OrbitComponent::SPIN, m_planetData.at("sun"), sunGeometry->getLocalTransform()});
 
   //create moon
   std::shared_ptr<Node> moonHolder = std::make_shared<Node>("moon-hold");
@@ -680,10 +602,32 @@ void ApplicationSolar::initializeSceneGraph() {
   std::shared_ptr<Node> moonOrbit = std::make_shared<GeometryNode>("moon-orbit", orbit_object, glm::vec3(), "wirenet");
 
   Planet moonData = m_planetData.at("moon");
-  moonHolder->setLocalTransform(glm::translate(glm::mat4(1), glm::vec3(moonData.orbitRadius, -.3f, 0)));
+  //moon orbits slightly below the earth
+  glm::fmat4 moonOffset = glm::translate(glm::mat4(1), glm::vec3(0, -.3f, 0));
+  moonHolder->setLocalTransform(glm::translate(glm::mat4(1), moonData.orbitPosition(0)) * moonOffset);
   moonGeometry->setLocalTransform(glm::rotate(glm::mat4(1), glm::radians(20.f), glm::vec3(0, 0, 1)) * glm::scale(glm::mat4(1), glm::vec3(moonData.diameter)));
-  moonGeometry->setTexture(loadTexture(planetsTexPath + "moon.jpg"));
-  moonOrbit->setLocalTransform(glm::scale(glm::mat4(1), glm::vec3(moonData.orbitRadius)));
+  moonGeometry->setTexture(planetTextures, textureLayers.at("moon"));
+  moonOrbit->setLocalTransform(moonData.orbitEllipse());
+  animations.add(moonHolder, OrbitComponent{OrbitComponent::ORBIT, moonData, moonOffset});
+  animations.add(moonGeometry, OrbitComponent{OrbitComponent::SPIN, moonData, moonGeometry->getLocalTransform()});
+
+  //create asteroid belt between mars and jupiter, all asteroids are drawn with one instanced draw call
+  m_asteroids = std::make_shared<InstancedGeometryNode>("asteroids", planet_object2, "planet_instanced");
+  m_asteroids->setTexture(planetTextures);
+  root->addChild(m_asteroids);
+
+  for (int i = 0; i < ASTEROID_COUNT; ++i) {
+    float brightness = glm::linearRand(.3f, .6f);
+    Planet asteroid{glm::linearRand(.02f, .08f), glm::linearRand(12.f, 13.5f), glm::linearRand(18.f, 19.f), 1,
+                    glm::fvec3(brightness), glm::linearRand(0.f, .1f), glm::linearRand(0.f, TWO_PI)};
+    std::shared_ptr<Node> asteroidHolder = std::make_shared<Node>("asteroid" + std::to_string(i));
+    glm::fmat4 asteroidScale = glm::scale(glm::mat4(1), glm::vec3(asteroid.diameter));
+
+    asteroidHolder->setLocalTransform(glm::translate(glm::mat4(1), asteroid.orbitPosition(0)) * asteroidScale);
+    animations.add(asteroidHolder, OrbitComponent{OrbitComponent::ORBIT, asteroid, asteroidScale});
+    m_asteroids->addChild(asteroidHolder);
+    m_asteroids->addInstance(asteroidHolder, asteroid.color, textureLayers.at("moon"));
+  }
 
   //create skyboxes
   skybox = std::make_shared<GeometryNode>("skyboxes", skybox_object, glm::vec3(), "skybox");
@@ -696,16 +640,15 @@ void ApplicationSolar::initializeSceneGraph() {
   earth->addChild(moonOrbit);
 }
 
-texture_object ApplicationSolar::loadTexture(std::string const& fileName) {
-  pixel_data pixels = texture_loader::file(fileName, false);
-  return utils::create_texture_object(pixels);
+texture_object ApplicationSolar::loadTexture(std::string const& fileName, std::array<std::uint8_t, 4> const& placeholder) {
+  return m_textureRegistry.acquire(fileName, placeholder);
 }
 
-texture_object ApplicationSolar::loadCubeMap(const std::string &path) {
-  texture_object textureObj{};
-  glGenTextures(1, &textureObj.handle);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureObj.handle);
+texture_object ApplicationSolar::loadTextureArray(std::vector<std::string> const& fileNames, std::size_t width, std::size_t height) {
+  return m_textureRegistry.acquireArray(fileNames, width, height);
+}
 
+texture_object ApplicationSolar::loadCubeMap(const std::string &path) {
   std::vector<std::string> faces {
       "right.png",
       "left.png",
@@ -714,18 +657,10 @@ texture_object ApplicationSolar::loadCubeMap(const std::string &path) {
       "front.png",
       "back.png",
   };
-  for (unsigned int i = 0; i < faces.size(); i++) {
-    pixel_data pixels = texture_loader::file(path + "/" + faces.at(i), false);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, pixels.channels, pixels.width, pixels.height, 0, pixels.channels, pixels.channel_type, pixels.ptr());
+  for (std::string& face : faces) {
+    face = path + "/" + face;
   }
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-  textureObj.target = GL_TEXTURE_CUBE_MAP;
-  return textureObj;
+  return m_textureRegistry.acquireCubeMap(faces);
 }
 
 void ApplicationSolar::initializeKeyMap() {
@@ -788,6 +723,10 @@ void ApplicationSolar::keyCallback(int key, int action, int mods) {
     m_keys_down.erase(key);
   }
 
+  if (action == GLFW_PRESS && key == GLFW_KEY_P) {
+    printRenderStats();
+  }
+
   if (action == GLFW_PRESS) {
     //is key in shader key map
     if (m_shader_key_map.find(key) == m_shader_key_map.end()) {
@@ -798,10 +737,15 @@ void ApplicationSolar::keyCallback(int key, int action, int mods) {
     //toggle enabled value
     m_shader_toggle_map[uniformVal] = 1 - m_shader_toggle_map[uniformVal];
     //upload toggles value to shader
-    auto shaderName = uniformVal == "IsCelEnabled" ? "planet" : "post_process";
+    std::vector<std::string> shaderNames{"post_process"};
 
-    glUseProgram(m_shaders.at(shaderName).handle);
-    glUniform1i(m_shaders.at(shaderName).u_locs.at(uniformVal), m_shader_toggle_map[uniformVal]);
+    if (uniformVal == "IsCelEnabled") {
+      shaderNames = {"planet", "planet_instanced"};
+    }
+    for (std::string const& shaderName : shaderNames) {
+      glUseProgram(m_shaders.at(shaderName).handle);
+      glUniform1i(m_shaders.at(shaderName).u_locs.at(uniformVal), m_shader_toggle_map[uniformVal]);
+    }
   }
 }
 
@@ -822,6 +766,7 @@ void ApplicationSolar::resizeCallback(unsigned width, unsigned height) {
   std::cout << "resize\n";
   //recalculate projection matrix for new aspect ratio
   m_cam->setProjectionMatrix(utils::calculate_projection_matrix(float(width) / float(height)));
+  m_viewportHeight = height;
 }
 
 // exe entry point
@@ -0,0 +1,118 @@
+// bakes images into block compressed mip chains next to them, the applications load those instead of the images
+#include "task_scheduler.hpp"
+#include "texture_cache.hpp"
+#include "texture_loader.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// parse a size given as <width>x<height>, false if the text is none
+static bool parse_size(char const* text, std::size_t& width, std::size_t& height) {
+  unsigned long w = 0;
+  unsigned long h = 0;
+  char end = 0;
+
+  if (std::sscanf(text, "%lux%lu%c", &w, &h, &end) != 2 || w == 0 || h == 0) {
+    return false;
+  }
+  width = std::size_t(w);
+  height = std::size_t(h);
+  return true;
+}
+
+// copy of 8 bit rgb pixels with an opaque alpha channel
+static pixel_data add_alpha(pixel_data const& image) {
+  std::size_t count = image.width * image.height;
+  pixel_data rgba{std::vector<std::uint8_t>(count * 4), GL_RGBA, image.channel_type, image.width, image.height};
+  std::uint8_t const* source = static_cast<std::uint8_t const*>(image.ptr());
+  std::uint8_t* target = rgba.pixels.get();
+
+  for (std::size_t i = 0; i < count; ++i) {
+    std::memcpy(target + i * 4, source + i * 3, 3);
+    target[i * 4 + 3] = 255;
+  }
+  return rgba;
+}
+
+int main(int argc, char* argv[]) {
+  // layers of array textures must all have the same size and format, which the option enforces for the given files
+  std::size_t arrayWidth = 0;
+  std::size_t arrayHeight = 0;
+  int firstFile = 1;
+
+  if (argc > 1 && std::string(argv[1]) == "--array-size") {
+    if (argc < 3 || !parse_size(argv[2], arrayWidth, arrayHeight)) {
+      std::cerr << "texture_baker: --array-size expects <width>x<height>" << std::endl;
+      return 1;
+    }
+    firstFile = 3;
+  }
+  if (argc <= firstFile) {
+    std::cerr << "usage: texture_baker [--array-size <width>x<height>] <image files>" << std::endl;
+    return 1;
+  }
+  bool isArray = arrayWidth > 0;
+  std::vector<std::string> files(argv + firstFile, argv + argc);
+  std::vector<pixel_data> images(files.size());
+  // one char per image rather than packed bits, so workers can set their entries concurrently
+  std::vector<char> isDecoded(files.size(), 0);
+  std::mutex outputMutex;
+  std::atomic<std::size_t> failures{0};
+  std::atomic<bool> hasAlpha{false};
+
+  // every image is decoded on its own, array layers are brought to the array size
+  TaskScheduler::get().parallelFor(files.size(), 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      try {
+        images[i] = texture_loader::file(files[i], false);
+        if (isArray && (images[i].width != arrayWidth || images[i].height != arrayHeight)) {
+          images[i] = texture_loader::resize(images[i], arrayWidth, arrayHeight);
+        }
+        if (images[i].channels == GL_RGBA) {
+          hasAlpha = true;
+        }
+        isDecoded[i] = 1;
+      } catch (std::logic_error const& error) {
+        ++failures;
+        std::lock_guard<std::mutex> lock{outputMutex};
+        std::cerr << files[i] << ": " << error.what() << std::endl;
+      }
+    }
+  });
+
+  // then filtered and compressed, all layers of an array use bc3 as soon as one of them has alpha
+  TaskScheduler::get().parallelFor(files.size(), 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (!isDecoded[i]) {
+        continue;
+      }
+      try {
+        pixel_data& image = images[i];
+        if (isArray && hasAlpha && image.channels == GL_RGB) {
+          image = add_alpha(image);
+        }
+        std::vector<char> contents = texture_cache::serialize(image, files[i]);
+        texture_cache::write(texture_cache::cache_path(files[i]), contents);
+
+        std::size_t components = image.channels == GL_RGBA ? 4 : 3;
+        std::lock_guard<std::mutex> lock{outputMutex};
+        std::cout << files[i] << ": " << image.width << "x" << image.height << ", "
+                  << image.width * image.height * components / 1024 << " KB -> "
+                  << contents.size() / 1024 << " KB " << (components == 4 ? "bc3" : "bc1") << " with mip levels" << std::endl;
+      } catch (std::logic_error const& error) {
+        ++failures;
+        std::lock_guard<std::mutex> lock{outputMutex};
+        std::cerr << files[i] << ": " << error.what() << std::endl;
+      }
+      // the decoded image is not needed anymore
+      images[i] = pixel_data{};
+    }
+  });
+  return failures == 0 ? 0 : 1;
+}
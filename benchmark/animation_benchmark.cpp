@@ -0,0 +1,108 @@
+// compares the per frame cost of name based planet animation with the component based animation system
+#include "benchmark_utils.hpp"
+#include "node.hpp"
+#include "animation_system.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include "planet.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// number of measured frames per run
+static const int FRAMES = 100;
+// simulated frame time
+static const double FRAME_TIME = 1.0 / 144.0;
+
+// planets with a holder node for the orbit and a geometry node for the spin, like the solar system scene
+static std::shared_ptr<Node> buildPlanets(std::size_t planetCount, std::map<std::string, Planet>& planetData, AnimationSystem& animations) {
+  std::shared_ptr<Node> root = std::make_shared<Node>("root");
+
+  for (std::size_t i = 0; i < planetCount; ++i) {
+    std::string name = "planet" + std::to_string(i);
+    Planet planet{1, float(i % 20 + 5), float(i % 50 + 4), float(i % 5 + 1), glm::fvec3(1), .05f, float(i)};
+    planetData.emplace(name, planet);
+
+    std::shared_ptr<Node> holder = std::make_shared<Node>(name + "-hold");
+    std::shared_ptr<Node> geometry = std::make_shared<Node>(name + "-geom");
+    std::shared_ptr<Node> orbit = std::make_shared<Node>(name + "-orbit");
+    holder->setLocalTransform(glm::translate(glm::fmat4(1), glm::fvec3(planet.orbitRadius, 0, 0)));
+    holder->addChild(geometry);
+    root->addChild(holder);
+    root->addChild(orbit);
+
+    animations.add(holder, OrbitComponent{OrbitComponent::ORBIT, planet, glm::fmat4(1)});
+    animations.add(geometry, OrbitComponent{OrbitComponent::SPIN, planet, glm::fmat4(1)});
+  }
+  return root;
+}
+
+// animation as it was done before, parsing the node names each frame
+static void rotateByName(std::shared_ptr<Node> const& root, std::map<std::string, Planet> const& planetData, double dTime) {
+  root->iterate([&planetData, &dTime] (std::shared_ptr<Node> node) -> void {
+    std::string nodeName = node->getName();
+    std::string planetName = nodeName.substr(0, nodeName.find('-'));
+    auto iter = planetData.find(planetName);
+
+    if (iter == planetData.end()) {
+      return;
+    }
+    Planet planet = iter->second;
+    float angle = 0;
+
+    if (nodeName.find("hold") != std::string::npos) {
+      angle = (float) dTime / planet.orbitPeriod * 360;
+    } else if (nodeName.find("geom") != std::string::npos){
+      angle = (float) dTime / planet.rotationPeriod * 360;
+    } else {
+      return;
+    }
+    glm::fmat4 rotation = glm::rotate(glm::fmat4(1), glm::radians(angle), glm::fvec3(0, 1, 0));
+    node->setLocalTransform(rotation * node->getLocalTransform());
+  });
+}
+
+// average time of one frame in microseconds
+template<typename Func>
+static double measureFrameUs(Func func) {
+  return measureUs([&]() {
+    for (int frame = 0; frame < FRAMES; ++frame) {
+      func();
+    }
+  }) / FRAMES;
+}
+
+static void runBenchmark(std::size_t planetCount) {
+  std::map<std::string, Planet> planetData;
+  AnimationSystem animations;
+  std::shared_ptr<Node> root = buildPlanets(planetCount, planetData, animations);
+
+  double lambdaUs = measureFrameUs([&]() {
+    rotateByName(root, planetData, FRAME_TIME);
+  });
+  double componentUs = measureFrameUs([&]() {
+    animations.update(FRAME_TIME);
+  });
+
+  std::cout << planetCount << " planets: "
+            << "name lookup " << lambdaUs << " us/frame, "
+            << "components " << componentUs << " us/frame, "
+            << "speedup " << lambdaUs / componentUs << "x" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<std::size_t> planetCounts{1000, 10000, 50000};
+  // planet counts can be passed as arguments instead
+  if (argc > 1) {
+    planetCounts.clear();
+    for (int i = 1; i < argc; ++i) {
+      planetCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+  }
+  for (std::size_t count : planetCounts) {
+    runBenchmark(count);
+  }
+}
@@ -0,0 +1,27 @@
+#ifndef OPENGL_BENCHMARK_UTILS_HPP
+#define OPENGL_BENCHMARK_UTILS_HPP
+
+#include <chrono>
+
+// wall clock time of one call in the given unit
+template<typename Unit, typename Func>
+double measure(Func func) {
+  auto start = std::chrono::high_resolution_clock::now();
+  func();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, Unit>(end - start).count();
+}
+
+// wall clock time of one call in milliseconds
+template<typename Func>
+double measureMs(Func func) {
+  return measure<std::milli>(func);
+}
+
+// wall clock time of one call in microseconds
+template<typename Func>
+double measureUs(Func func) {
+  return measure<std::micro>(func);
+}
+
+#endif
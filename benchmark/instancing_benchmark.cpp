@@ -0,0 +1,214 @@
+// compares the frame time of drawing many planets with one GeometryNode each against one InstancedGeometryNode
+#include "benchmark_utils.hpp"
+#include "geometry_node.hpp"
+#include "instanced_geometry_node.hpp"
+#include "model_loader.hpp"
+#include "shader_loader.hpp"
+#include "utils.hpp"
+#include "pixel_data.hpp"
+#include "render_queue.hpp"
+#include "frame_data.hpp"
+
+#include <glbinding/Binding.h>
+#include <glbinding/gl/gl.h>
+using namespace gl;
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// number of measured frames per run
+static const int FRAMES = 10;
+// size of the offscreen framebuffer
+static const GLsizei WIDTH = 1280;
+static const GLsizei HEIGHT = 720;
+
+// create program and request the locations of the given uniforms
+static shader_program createProgram(std::string const& vertexPath, std::string const& fragmentPath, std::vector<std::string> const& uniforms) {
+  shader_program program{{{GL_VERTEX_SHADER, vertexPath}, {GL_FRAGMENT_SHADER, fragmentPath}}};
+  program.handle = shader_loader::program(program.shader_paths);
+
+  for (std::string const& uniform : uniforms) {
+    program.u_locs[uniform] = utils::glGetUniformLocation(program.handle, uniform.c_str());
+  }
+  utils::update_uniform_handles(program);
+  utils::bind_uniform_block(program.handle, "FrameData", FRAME_DATA_BINDING);
+  return program;
+}
+
+// camera and light shared by both programs through the FrameData block
+static GLuint createFrameData() {
+  frame_data frame{};
+  frame.view_matrix = glm::lookAt(glm::fvec3(0, 0, 30), glm::fvec3(0), glm::fvec3(0, 1, 0));
+  frame.projection_matrix = utils::calculate_projection_matrix(float(WIDTH) / float(HEIGHT));
+  frame.camera_pos = glm::fvec3(0, 0, 30);
+  frame.point_light_pos = glm::fvec3(0, 0, 40);
+  frame.point_light_color = glm::fvec3(1000);
+  frame.ambient_light = glm::fvec3(.5f);
+
+  GLuint buffer = 0;
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(frame_data), &frame, GL_STATIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, buffer);
+  return buffer;
+}
+
+// position of a planet on a grid filling the view
+static glm::fmat4 gridTransform(std::size_t index, std::size_t count) {
+  std::size_t columns = std::size_t(std::sqrt(double(count))) + 1;
+  float spacing = 30.f / float(columns);
+  glm::fvec3 position{float(index % columns) * spacing - 15.f, float(index / columns) * spacing - 15.f, 0};
+  return glm::scale(glm::translate(glm::fmat4(1), position), glm::fvec3(spacing * .1f));
+}
+
+// average time of one frame in milliseconds
+template<typename Func>
+static double measureFrameMs(Func func) {
+  // first frame uploads buffers and compiles state, do not measure it
+  func();
+  glFinish();
+
+  return measureMs([&]() {
+    for (int frame = 0; frame < FRAMES; ++frame) {
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      func();
+    }
+    // wait for the gpu to finish all frames
+    glFinish();
+  }) / FRAMES;
+}
+
+static void runBenchmark(std::size_t planetCount, model_object const& geometry, texture_object const& texture,
+                         std::map<std::string, shader_program> const& shaders) {
+  std::shared_ptr<Node> nodeRoot = std::make_shared<Node>("root");
+  std::shared_ptr<InstancedGeometryNode> instanced = std::make_shared<InstancedGeometryNode>("instanced", geometry, "planet_instanced");
+  instanced->setTexture(texture);
+  model_object nodeGeometry = geometry;
+
+  for (std::size_t i = 0; i < planetCount; ++i) {
+    glm::fmat4 transform = gridTransform(i, planetCount);
+    glm::fvec3 color{.5f};
+
+    std::shared_ptr<GeometryNode> node = std::make_shared<GeometryNode>(std::to_string(i), nodeGeometry, color, "planet");
+    node->setTexture(texture);
+    node->setLocalTransform(transform);
+    nodeRoot->addChild(node);
+
+    std::shared_ptr<Node> instance = std::make_shared<Node>(std::to_string(i));
+    instance->setLocalTransform(transform);
+    instanced->addChild(instance);
+    instanced->addInstance(instance, color);
+  }
+  glm::fmat4 view{};
+  RenderQueue queue{};
+
+  double nodeMs = measureFrameMs([&]() {
+    queue.clear();
+    nodeRoot->collect(queue, shaders, view);
+    queue.submit();
+  });
+  double instancedMs = measureFrameMs([&]() {
+    instanced->render(shaders, view);
+  });
+
+  std::cout << planetCount << " planets: "
+            << "GeometryNode " << nodeMs << " ms/frame (" << queue.getStats().drawCalls << " draw calls, "
+            << queue.getStats().programBindsAvoided + queue.getStats().vertexArrayBindsAvoided + queue.getStats().textureBindsAvoided << " binds avoided), "
+            << "InstancedGeometryNode " << instancedMs << " ms/frame (1 draw call), "
+            << "speedup " << nodeMs / instancedMs << "x" << std::endl;
+  instanced->releaseBuffers();
+}
+
+int main(int argc, char* argv[]) {
+  glfwInit();
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, 1);
+  // rendering goes to an offscreen framebuffer, so no window has to be shown
+  glfwWindowHint(GLFW_VISIBLE, 0);
+  GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "instancing benchmark", nullptr, nullptr);
+  glfwMakeContextCurrent(window);
+  glbinding::Binding::initialize();
+
+  // first argument is the resource path, as for the applications
+  std::string resourcePath = utils::read_resource_path(argc, argv);
+  std::vector<std::size_t> planetCounts{1000, 10000};
+  // planet counts can be passed after the resource path instead
+  if (argc > 2) {
+    planetCounts.clear();
+    for (int i = 2; i < argc; ++i) {
+      planetCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+  }
+
+  // draw buffers independent of the window system and its vsync
+  GLuint framebuffer = 0;
+  GLuint renderbuffers[2] = {0, 0};
+  glGenFramebuffers(1, &framebuffer);
+  glGenRenderbuffers(2, renderbuffers);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, WIDTH, HEIGHT);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+  glViewport(0, 0, WIDTH, HEIGHT);
+  glEnable(GL_DEPTH_TEST);
+
+  std::cout << "renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  model planetModel = model_loader::obj(resourcePath + "models/sphere1.obj", model::NORMAL | model::TEXCOORD);
+  model_object geometry = utils::create_model_object(planetModel, GL_TRIANGLES);
+  // low polygon sphere and plain white texture, like asteroids, so the draw submission dominates
+  // the planet shaders sample an array texture, so the white pixel is its only layer
+  texture_object texture{};
+  texture.target = GL_TEXTURE_2D_ARRAY;
+  std::vector<std::uint8_t> white{255, 255, 255, 255};
+  glGenTextures(1, &texture.handle);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture.handle);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+
+  std::map<std::string, shader_program> shaders{};
+  std::vector<std::string> instancedUniforms{"Tex", "NormalMap"};
+  std::vector<std::string> planetUniforms = instancedUniforms;
+  planetUniforms.insert(planetUniforms.end(), {"ModelMatrix", "NormalMatrix", "Color", "IsNormalMapEnabled"});
+
+  shaders.emplace("planet", createProgram(resourcePath + "shaders/simple.vert", resourcePath + "shaders/simple.frag", planetUniforms));
+  shaders.emplace("planet_instanced", createProgram(resourcePath + "shaders/simple_instanced.vert", resourcePath + "shaders/simple.frag", instancedUniforms));
+
+  GLuint frameData = createFrameData();
+  // textures are bound to unit 0, the normal map sampler of another type needs its own unit
+  for (auto const& pair : shaders) {
+    glUseProgram(pair.second.handle);
+    glUniform1i(pair.second.u_locs.at("Tex"), 0);
+    glUniform1i(pair.second.u_locs.at("NormalMap"), 1);
+  }
+  for (std::size_t count : planetCounts) {
+    runBenchmark(count, geometry, texture, shaders);
+  }
+
+  for (auto const& pair : shaders) {
+    glDeleteProgram(pair.second.handle);
+  }
+  glDeleteBuffers(1, &frameData);
+  glDeleteTextures(1, &texture.handle);
+  glDeleteBuffers(1, &geometry.vertex_BO);
+  glDeleteBuffers(1, &geometry.element_BO);
+  glDeleteVertexArrays(1, &geometry.vertex_AO);
+  glDeleteRenderbuffers(2, renderbuffers);
+  glDeleteFramebuffers(1, &framebuffer);
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+}
@@ -0,0 +1,55 @@
+// compares parsing obj files with mapping their binary mesh cache
+#include "benchmark_utils.hpp"
+#include "mesh_cache.hpp"
+#include "model_loader.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void runBenchmark(std::string const& path, std::size_t loadCount) {
+  model::attrib_flag_t attributes = model::NORMAL | model::TEXCOORD;
+  // start without cache, so the first load has to write it
+  std::remove(mesh_cache::cache_path(path).c_str());
+
+  std::size_t checksum = 0;
+  double writeMs = measureMs([&]() {
+    checksum += mesh_cache::obj(path, attributes).getVertexCount();
+  });
+  double parseMs = measureMs([&]() {
+    for (std::size_t i = 0; i < loadCount; ++i) {
+      checksum += model_loader::obj(path, attributes).vertex_num;
+    }
+  });
+  double mapMs = measureMs([&]() {
+    for (std::size_t i = 0; i < loadCount; ++i) {
+      MappedMesh mesh = mesh_cache::obj(path, attributes);
+      // touch the data like an upload would
+      std::size_t indexBytes = mesh.getIndexCount() * std::size_t(mesh.getIndexFormat().size);
+      checksum += mesh.getVertexCount() + std::size_t(static_cast<unsigned char const*>(mesh.getIndices())[indexBytes - 1]);
+    }
+  });
+
+  std::cout << path << ", " << loadCount << " loads: "
+            << "parse " << parseMs << " ms, "
+            << "first load writing the cache " << writeMs << " ms, "
+            << "mapped " << mapMs << " ms, "
+            << "speedup " << parseMs / mapMs << "x "
+            << "(checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  // first argument is the resource path, as for the applications
+  std::string resourcePath = utils::read_resource_path(argc, argv);
+  std::size_t loadCount = 100;
+  // number of loads per model can be passed after the resource path
+  if (argc > 2) {
+    loadCount = std::strtoul(argv[2], nullptr, 10);
+  }
+  for (char const* name : {"models/sphere.obj", "models/sphere1.obj"}) {
+    runBenchmark(resourcePath + name, loadCount);
+  }
+}
@@ -0,0 +1,85 @@
+// measures the vertex cache efficiency of meshes before and after optimization and the level of detail generation
+#include "benchmark_utils.hpp"
+#include "mesh_processing.hpp"
+#include "model_loader.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// cache sizes the miss ratio is reported for, 32 is the one optimized for
+static const std::size_t SMALL_CACHE_SIZE = 16;
+
+// grid of the given size with its triangles in random order, as in meshes assembled from unordered scans
+static model shuffledGrid(std::size_t size) {
+  std::vector<GLfloat> positions;
+  for (std::size_t y = 0; y <= size; ++y) {
+    for (std::size_t x = 0; x <= size; ++x) {
+      positions.insert(positions.end(), {float(x), float(y), 0.0f});
+    }
+  }
+  std::vector<std::size_t> cells(size * size);
+  for (std::size_t i = 0; i < cells.size(); ++i) {
+    cells[i] = i;
+  }
+  std::shuffle(cells.begin(), cells.end(), std::mt19937{42});
+
+  std::vector<GLuint> indices;
+  for (std::size_t cell : cells) {
+    GLuint a = GLuint(cell / size * (size + 1) + cell % size);
+    GLuint b = a + GLuint(size + 1);
+    indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+  }
+  return model{positions, model::POSITION, indices};
+}
+
+static void runBenchmark(std::string const& name, model mdl) {
+  double acmrBefore = mesh_processing::acmr(mdl.indices);
+  double smallBefore = mesh_processing::acmr(mdl.indices, SMALL_CACHE_SIZE);
+  double optimizeMs = measureMs([&]() {
+    model_loader::optimize(mdl);
+  });
+
+  std::cout << name << ", " << mdl.indices.size() / 3 << " triangles: "
+            << "acmr " << acmrBefore << " -> " << mesh_processing::acmr(mdl.indices) << ", "
+            << "with " << SMALL_CACHE_SIZE << " entries " << smallBefore << " -> " << mesh_processing::acmr(mdl.indices, SMALL_CACHE_SIZE) << ", "
+            << "optimized in " << optimizeMs << " ms" << std::endl;
+
+  double lodMs = measureMs([&]() {
+    model_loader::generate_lods(mdl);
+  });
+  std::cout << "  levels of detail built in " << lodMs << " ms:";
+  for (model::lod const& level : mdl.lods) {
+    std::cout << " " << level.index_count / 3 << " triangles (error " << level.error << ")";
+  }
+  std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  // first argument is the resource path, as for the applications
+  std::string resourcePath = utils::read_resource_path(argc, argv);
+  for (char const* name : {"models/sphere.obj", "models/sphere1.obj"}) {
+    mesh_processing::weld_result welded{};
+    model mdl = model_loader::obj(resourcePath + name, model::NORMAL | model::TEXCOORD, model_loader::WELD_VERTICES, &welded);
+    std::cout << name << " welded from " << welded.vertices_before << " to " << welded.vertices_after
+              << " vertices, " << welded.reduction() * 100.0 << "% less" << std::endl;
+    runBenchmark(name, std::move(mdl));
+  }
+
+  std::vector<std::size_t> gridSizes{100, 1000};
+  // grid sizes can be passed after the resource path
+  if (argc > 2) {
+    gridSizes.clear();
+    for (int i = 2; i < argc; ++i) {
+      gridSizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+  }
+  for (std::size_t size : gridSizes) {
+    runBenchmark("shuffled grid " + std::to_string(size), shuffledGrid(size));
+  }
+}
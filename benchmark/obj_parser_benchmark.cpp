@@ -0,0 +1,115 @@
+// compares the throughput of tinyobjloader with the chunked obj parser
+#include "benchmark_utils.hpp"
+#include "obj_parser.hpp"
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// written into the working directory and removed afterwards
+static const char* const MESH_PATH = "obj_parser_benchmark.obj";
+
+// write a sphere with positions, normals and texcoords, returns the file size in bytes
+static long writeSphere(std::size_t triangleCount) {
+  std::size_t rings = std::max(std::size_t(std::sqrt(double(triangleCount) / 4.0)), std::size_t(2));
+  std::size_t segments = std::max(triangleCount / (2 * rings), std::size_t(3));
+  std::FILE* file = std::fopen(MESH_PATH, "w");
+
+  if (file == nullptr) {
+    return 0;
+  }
+  std::fprintf(file, "# %zu rings, %zu segments\no sphere\n", rings, segments);
+  for (std::size_t ring = 0; ring <= rings; ++ring) {
+    double theta = 3.14159265358979 * double(ring) / double(rings);
+
+    for (std::size_t segment = 0; segment <= segments; ++segment) {
+      double phi = 2.0 * 3.14159265358979 * double(segment) / double(segments);
+      double x = std::sin(theta) * std::cos(phi);
+      double y = std::cos(theta);
+      double z = std::sin(theta) * std::sin(phi);
+      std::fprintf(file, "v %f %f %f\nvn %f %f %f\nvt %f %f\n", x, y, z, x, y, z,
+                   double(segment) / double(segments), double(ring) / double(rings));
+    }
+  }
+  for (std::size_t ring = 0; ring < rings; ++ring) {
+    for (std::size_t segment = 0; segment < segments; ++segment) {
+      std::size_t a = ring * (segments + 1) + segment + 1;
+      std::size_t b = a + segments + 1;
+      std::fprintf(file, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, b, b, b, a + 1, a + 1, a + 1);
+      std::fprintf(file, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a + 1, a + 1, a + 1, b, b, b, b + 1, b + 1, b + 1);
+    }
+  }
+  long size = std::ftell(file);
+  std::fclose(file);
+  return size;
+}
+
+// largest difference between the attributes, or infinity if the meshes are not built the same way
+static float compare(std::vector<tinyobj::shape_t> const& a, std::vector<tinyobj::shape_t> const& b) {
+  float maxError = 0;
+
+  if (a.size() != b.size()) {
+    return INFINITY;
+  }
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    tinyobj::mesh_t const& meshA = a[i].mesh;
+    tinyobj::mesh_t const& meshB = b[i].mesh;
+
+    if (meshA.indices != meshB.indices || meshA.positions.size() != meshB.positions.size() ||
+        meshA.normals.size() != meshB.normals.size() || meshA.texcoords.size() != meshB.texcoords.size()) {
+      return INFINITY;
+    }
+    for (std::size_t j = 0; j < meshA.positions.size(); ++j) {
+      maxError = std::max(maxError, std::abs(meshA.positions[j] - meshB.positions[j]));
+    }
+    for (std::size_t j = 0; j < meshA.normals.size(); ++j) {
+      maxError = std::max(maxError, std::abs(meshA.normals[j] - meshB.normals[j]));
+    }
+    for (std::size_t j = 0; j < meshA.texcoords.size(); ++j) {
+      maxError = std::max(maxError, std::abs(meshA.texcoords[j] - meshB.texcoords[j]));
+    }
+  }
+  return maxError;
+}
+
+static void runBenchmark(std::size_t triangleCount) {
+  double megabytes = double(writeSphere(triangleCount)) / (1024.0 * 1024.0);
+  std::vector<tinyobj::shape_t> tinyShapes;
+  std::vector<tinyobj::shape_t> parsedShapes;
+
+  double tinyMs = measureMs([&]() {
+    std::vector<tinyobj::material_t> materials;
+    tinyobj::LoadObj(tinyShapes, materials, MESH_PATH);
+  });
+  double parserMs = measureMs([&]() {
+    parsedShapes = obj_parser::load(MESH_PATH);
+  });
+  std::remove(MESH_PATH);
+
+  std::size_t triangles = parsedShapes.empty() ? 0 : parsedShapes[0].mesh.indices.size() / 3;
+  std::cout << triangles << " triangles, " << megabytes << " MB: "
+            << "tinyobjloader " << megabytes / tinyMs * 1000.0 << " MB/s, "
+            << "obj parser " << megabytes / parserMs * 1000.0 << " MB/s, "
+            << "speedup " << tinyMs / parserMs << "x, "
+            << "max error " << compare(tinyShapes, parsedShapes) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<std::size_t> triangleCounts{100000, 2000000};
+  // triangle counts can be passed as arguments instead
+  if (argc > 1) {
+    triangleCounts.clear();
+    for (int i = 1; i < argc; ++i) {
+      triangleCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+  }
+  std::cout << "obj parser uses " << TaskScheduler::get().getWorkerCount() + 1 << " threads" << std::endl;
+  for (std::size_t count : triangleCounts) {
+    runBenchmark(count);
+  }
+}
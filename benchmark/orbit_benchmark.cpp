@@ -0,0 +1,74 @@
+// compares evaluating orbits one planet at a time with the batched orbit kernel
+#include "benchmark_utils.hpp"
+#include "orbit_kernel.hpp"
+#include "planet.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// number of measured frames per run
+static const int FRAMES = 20;
+// simulated frame time
+static const double FRAME_TIME = 1.0 / 144.0;
+
+// average time of one frame in milliseconds, func gets the simulation time of the frame
+template<typename Func>
+static double measureFrameMs(Func func) {
+  return measureMs([&]() {
+    for (int frame = 0; frame < FRAMES; ++frame) {
+      func(frame * FRAME_TIME);
+    }
+  }) / FRAMES;
+}
+
+static void runBenchmark(std::size_t bodyCount) {
+  std::vector<Planet> planets{};
+  OrbitBatch orbits{};
+
+  for (std::size_t i = 0; i < bodyCount; ++i) {
+    Planet planet{1, float(i % 20 + 5), float(i % 50 + 4), float(i % 5 + 1), glm::fvec3(1), float(i % 9) * .02f, float(i % 628) * .01f};
+    planets.push_back(planet);
+    orbits.add(planet);
+  }
+  std::vector<glm::fvec3> positions(bodyCount);
+  std::vector<float> x(bodyCount);
+  std::vector<float> z(bodyCount);
+
+  double scalarMs = measureFrameMs([&](double time) {
+    for (std::size_t i = 0; i < bodyCount; ++i) {
+      positions[i] = planets[i].orbitPosition(time);
+    }
+  });
+  double batchMs = measureFrameMs([&](double time) {
+    orbit_kernel::evaluate(orbits, time, 0, bodyCount, x.data(), z.data());
+  });
+  // both paths must agree, compare at the last measured time
+  float maxError = 0;
+  for (std::size_t i = 0; i < bodyCount; ++i) {
+    maxError = std::max(maxError, std::abs(positions[i].x - x[i]));
+    maxError = std::max(maxError, std::abs(positions[i].z - z[i]));
+  }
+
+  std::cout << bodyCount << " bodies: "
+            << "per planet " << scalarMs << " ms/frame, "
+            << orbit_kernel::instruction_set() << " batch " << batchMs << " ms/frame, "
+            << "speedup " << scalarMs / batchMs << "x, "
+            << "max error " << maxError << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<std::size_t> bodyCounts{100000, 1000000};
+  // body counts can be passed as arguments instead
+  if (argc > 1) {
+    bodyCounts.clear();
+    for (int i = 1; i < argc; ++i) {
+      bodyCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+  }
+  for (std::size_t count : bodyCounts) {
+    runBenchmark(count);
+  }
+}
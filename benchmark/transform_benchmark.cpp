@@ -0,0 +1,98 @@
+// compares hierarchy updates of nodes resolving their own transforms with nodes attached to a TransformStore
+#include "benchmark_utils.hpp"
+#include "node.hpp"
+#include "transform_store.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// children per node, keeps the tree shallow for large node counts
+static const std::size_t FAN_OUT = 8;
+// number of measured frames per run
+static const int FRAMES = 10;
+
+// build a tree with the given number of nodes below the root, filled level by level
+static std::shared_ptr<Node> buildTree(std::size_t nodeCount, std::vector<std::shared_ptr<Node>>& nodes) {
+  std::shared_ptr<Node> root = std::make_shared<Node>("root");
+  nodes.clear();
+  nodes.reserve(nodeCount + 1);
+  nodes.push_back(root);
+
+  for (std::size_t i = 1; i <= nodeCount; ++i) {
+    std::shared_ptr<Node> node = std::make_shared<Node>(std::to_string(i));
+    node->setLocalTransform(glm::translate(glm::mat4(1), glm::vec3(1, 0, 0)));
+    nodes[(i - 1) / FAN_OUT]->addChild(node);
+    nodes.push_back(node);
+  }
+  return root;
+}
+
+// rotation applied to every node each frame
+static glm::mat4 frameRotation(int frame) {
+  return glm::rotate(glm::mat4(1), 0.01f * float(frame + 1), glm::vec3(0, 1, 0));
+}
+
+static void runBenchmark(std::size_t nodeCount) {
+  std::vector<std::shared_ptr<Node>> nodes;
+  std::shared_ptr<Node> root = buildTree(nodeCount, nodes);
+  // prevents the compiler from skipping the transform calculation
+  float checksum = 0;
+
+  // every node moves each frame and all world transforms are requested, as in the render pass
+  double iterateMs = measureMs([&]() {
+    for (int frame = 0; frame < FRAMES; ++frame) {
+      glm::mat4 rotation = frameRotation(frame);
+      root->iterate([&rotation](std::shared_ptr<Node> node) {
+        node->setLocalTransform(rotation * node->getLocalTransform());
+      });
+      root->iterate([&checksum](std::shared_ptr<Node> node) {
+        checksum += node->getWorldTransform()[3][0];
+      });
+    }
+  }) / FRAMES;
+
+  // same work through the nodes, as the animation system and the renderer access them
+  auto updateNodes = [&]() {
+    for (int frame = 0; frame < FRAMES; ++frame) {
+      glm::mat4 rotation = frameRotation(frame);
+      // the root keeps its transform, like the scene graph root
+      for (std::size_t i = 1; i < nodes.size(); ++i) {
+        nodes[i]->setLocalTransform(rotation * nodes[i]->getLocalTransform());
+      }
+      for (std::shared_ptr<Node> const& node : nodes) {
+        checksum += node->getWorldTransform()[3][0];
+      }
+    }
+  };
+  double nodeMs = measureMs(updateNodes) / FRAMES;
+
+  TransformStore store;
+  store.build(root);
+  double storeMs = measureMs(updateNodes) / FRAMES;
+  store.clear();
+
+  std::cout << nodeCount << " nodes: "
+            << "Node::iterate " << iterateMs << " ms/frame, "
+            << "node list " << nodeMs << " ms/frame, "
+            << "node list with TransformStore " << storeMs << " ms/frame, "
+            << "speedup " << nodeMs / storeMs << "x"
+            << " (checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<std::size_t> nodeCounts{10000, 100000, 1000000};
+  // node counts can be passed as arguments instead
+  if (argc > 1) {
+    nodeCounts.clear();
+    for (int i = 1; i < argc; ++i) {
+      nodeCounts.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+  }
+  for (std::size_t count : nodeCounts) {
+    runBenchmark(count);
+  }
+}
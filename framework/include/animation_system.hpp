@@ -0,0 +1,72 @@
+#ifndef OPENGL_FRAMEWORK_ANIMATION_SYSTEM_HPP
+#define OPENGL_FRAMEWORK_ANIMATION_SYSTEM_HPP
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "orbit_kernel.hpp"
+#include "planet.hpp"
+
+class Node;
+
+// motion of a node evaluated from the absolute simulation time
+struct OrbitComponent {
+  enum Motion {
+    // move the node along the orbit of the planet
+    ORBIT,
+    // rotate the node around its own y axis
+    SPIN
+  };
+  Motion motion;
+  // orbit and rotation parameters
+  Planet planet;
+  // local transform the motion is applied to
+  glm::fmat4 base;
+};
+
+// animates nodes with components stored in dense arrays instead of looking them up per node
+// components do not keep their nodes alive, components of destroyed nodes are dropped on the next update
+class AnimationSystem {
+public:
+  AnimationSystem();
+  // attach a component to a node
+  void add(std::shared_ptr<Node> const& node, OrbitComponent const& component);
+  // remove all components of a node, e.g. when it is removed from the graph but still used elsewhere
+  void remove(Node const& node);
+  void clear();
+  // number of components
+  std::size_t size() const;
+  // advance the simulation time and evaluate all components, batches of components are processed in parallel
+  // tasks only set local transforms, which is safe for parents and children in different batches
+  // no world transform may be requested until update returns, it could resolve a half updated hierarchy
+  void update(double dTime);
+  // jump to a simulation time, takes effect on the next update
+  void setTime(double time);
+  double getTime() const;
+
+private:
+  // remove components whose node has been destroyed
+  void removeExpired();
+  // remove a component by moving the last one into its place
+  void removeOrbit(std::size_t index);
+  void removeSpin(std::size_t index);
+
+  // seconds simulated since the start
+  double m_time;
+  // orbit components, evaluated in batches by the orbit kernel
+  // nodes are observed through weak pointers, the raw pointers are used while updating once they are known to be alive
+  std::vector<std::weak_ptr<Node>> m_orbitNodes;
+  std::vector<Node*> m_orbitTargets;
+  std::vector<glm::fmat4> m_orbitBases;
+  OrbitBatch m_orbits;
+  // orbit positions of the last update, same index as the orbits
+  std::vector<float> m_orbitX;
+  std::vector<float> m_orbitZ;
+  // spin components, same index as their node
+  std::vector<std::weak_ptr<Node>> m_spinNodes;
+  std::vector<Node*> m_spinTargets;
+  std::vector<OrbitComponent> m_spins;
+};
+
+#endif //OPENGL_FRAMEWORK_ANIMATION_SYSTEM_HPP
@@ -0,0 +1,31 @@
+#ifndef OPENGL_FRAMEWORK_FRAME_DATA_HPP
+#define OPENGL_FRAMEWORK_FRAME_DATA_HPP
+
+#include <glbinding/gl/types.h>
+#include <glm/glm.hpp>
+
+// use gl definitions from glbinding
+using namespace gl;
+
+// uniform buffer binding point of the FrameData block in all shaders
+static const GLuint FRAME_DATA_BINDING = 0;
+
+// camera and lighting data of one frame, laid out as the std140 FrameData block of the shaders
+struct frame_data {
+  glm::fmat4 view_matrix;
+  glm::fmat4 projection_matrix;
+  glm::fvec3 camera_pos;
+  // fills the fourth component of the camera position
+  float time;
+  // std140 aligns each vec3 to 16 bytes
+  glm::fvec3 point_light_pos;
+  float padding0;
+  glm::fvec3 point_light_color;
+  float padding1;
+  glm::fvec3 ambient_light;
+  float padding2;
+};
+
+static_assert(sizeof(frame_data) == 192, "frame_data must match the std140 layout of the FrameData block");
+
+#endif //OPENGL_FRAMEWORK_FRAME_DATA_HPP
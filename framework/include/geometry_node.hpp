@@ -10,17 +10,33 @@ public:
   GeometryNode(std::string const &name, model_object& geometry, glm::fvec3 color, std::string const& shader);
   model_object const& getGeometry();
   void setGeometry(model_object const& geometry);
-  void setTexture(texture_object const& texture);
+  // the layer selects the image of array textures
+  void setTexture(texture_object const& texture, GLint layer = 0);
   void setNormalMap(texture_object const& normalMap);
-  void render(std::map<std::string, shader_program> const& m_shaders, glm::mat4 const& view_transform) override;
+  void collect(RenderQueue& queue, std::map<std::string, shader_program> const& shaders, glm::mat4 const& view_transform) override;
+  void draw(shader_program const& shader) override;
 private:
+  // program of the node, looked up by name only when drawn with another shader map
+  shader_program const& getProgram(std::map<std::string, shader_program> const& shaders);
+  // coarsest level of detail whose error stays below a pixel at the given distance from the camera
+  std::size_t selectLod(glm::fmat4 const& world_transform, float depth, float lod_scale) const;
+
   model_object m_geometry;
+  // level of detail chosen while collecting, drawn by the following draw
+  std::size_t m_lod;
   texture_object m_texture;
+  GLint m_textureLayer;
   texture_object m_normalMap;
   bool m_hasNormalMap;
 
   glm::fvec3 m_color;
   std::string m_shader;
+  // properties of the shader resolved from its name at construction
+  bool m_isLit;
+  bool m_isSkybox;
+  // cached program and the map it was found in, map elements keep their address
+  shader_program const* m_program;
+  std::map<std::string, shader_program> const* m_programSource;
 };
 #endif //OPENGL_FRAMEWORK_GEOMETRY_NODE_HPP
 
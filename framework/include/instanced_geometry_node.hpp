@@ -0,0 +1,68 @@
+#ifndef OPENGL_FRAMEWORK_INSTANCED_GEOMETRY_NODE_HPP
+#define OPENGL_FRAMEWORK_INSTANCED_GEOMETRY_NODE_HPP
+
+#include "node.hpp"
+#include "structs.hpp"
+
+#include <vector>
+
+// draws one geometry at the world transforms of many nodes with a single instanced draw call
+class InstancedGeometryNode : public Node {
+public:
+  // first attribute location of the per instance data, locations before are left to the vertex attributes
+  static const GLuint INSTANCE_LOCATION = 5;
+
+  InstancedGeometryNode(std::string const& name, model_object const& geometry, std::string const& shader);
+
+  // draw the geometry at the world transform of the node, instances do not keep their node alive
+  // the layer selects the image of array textures per instance
+  void addInstance(std::shared_ptr<Node> const& node, glm::fvec3 const& color, GLint layer = 0);
+  void removeInstance(Node const& node);
+  std::size_t getInstanceCount() const;
+  // free the instance buffer while the context is still current, the next draw creates a new one
+  // not done on destruction, as nodes of the static scene graph outlive the context
+  void releaseBuffers();
+
+  model_object const& getGeometry();
+  void setTexture(texture_object const& texture);
+  void collect(RenderQueue& queue, std::map<std::string, shader_program> const& shaders, glm::mat4 const& view_transform) override;
+  void draw(shader_program const& shader) override;
+
+private:
+  // attributes of one instance, laid out as in the vertex shader
+  struct InstanceData {
+    glm::fmat4 modelMatrix;
+    glm::fmat3 normalMatrix;
+    glm::fvec3 color;
+    GLint layer;
+  };
+
+  // program of the node, looked up by name only when drawn with another shader map
+  shader_program const& getProgram(std::map<std::string, shader_program> const& shaders);
+  // remove an instance by moving the last one into its place
+  void eraseInstance(std::size_t index);
+  // collect transforms of all living instances into the instance data
+  void gatherInstances();
+  // create the instance buffer and attach it to the vertex array of the geometry
+  void initializeInstanceBuffer();
+
+  model_object m_geometry;
+  texture_object m_texture;
+  std::string m_shader;
+  // cached program and the map it was found in
+  shader_program const* m_program;
+  std::map<std::string, shader_program> const* m_programSource;
+
+  // nodes are observed through weak pointers, the raw pointers are used while gathering once they are known to be alive
+  std::vector<std::weak_ptr<Node>> m_instances;
+  std::vector<Node*> m_instanceTargets;
+  std::vector<glm::fvec3> m_colors;
+  std::vector<GLint> m_layers;
+  // data uploaded each frame, kept to not reallocate
+  std::vector<InstanceData> m_instanceData;
+  GLuint m_instance_BO;
+  // number of instances the buffer has storage for
+  std::size_t m_instanceCapacity;
+};
+
+#endif //OPENGL_FRAMEWORK_INSTANCED_GEOMETRY_NODE_HPP
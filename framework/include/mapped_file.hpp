@@ -0,0 +1,48 @@
+#ifndef OPENGL_FRAMEWORK_MAPPED_FILE_HPP
+#define OPENGL_FRAMEWORK_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// read only file contents mapped into memory, the data stays valid as long as the object lives
+class MappedFile {
+public:
+  // map the file, throws std::logic_error if it can not be opened
+  explicit MappedFile(std::string const& path);
+  // take contents that only exist in memory
+  explicit MappedFile(std::vector<char>&& contents);
+  MappedFile(MappedFile&& other);
+  MappedFile(MappedFile const&) = delete;
+  MappedFile& operator=(MappedFile const&) = delete;
+  // unmap the file
+  ~MappedFile();
+
+  char const* getData() const;
+  std::size_t getSize() const;
+
+private:
+  // release the mapped pages
+  void unmap();
+
+  char const* m_data;
+  std::size_t m_size;
+  // mapped pages on posix systems, buffer the file is read into otherwise
+  bool m_isMapped;
+  std::vector<char> m_buffer;
+};
+
+// file handling shared by the mesh and texture caches
+namespace file_cache {
+
+// size and modification time of a file, false if it does not exist
+bool file_stamp(std::string const& path, std::uint64_t& size, std::int64_t& time);
+
+// write the contents to a temporary file and move it over the path, so a crash never leaves a truncated file behind
+// throws std::logic_error if the file can not be written
+void write_atomic(std::string const& path, std::vector<char> const& contents);
+
+}
+
+#endif //OPENGL_FRAMEWORK_MAPPED_FILE_HPP
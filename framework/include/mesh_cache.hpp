@@ -0,0 +1,123 @@
+#ifndef OPENGL_FRAMEWORK_MESH_CACHE_HPP
+#define OPENGL_FRAMEWORK_MESH_CACHE_HPP
+
+#include "mapped_file.hpp"
+#include "mesh_processing.hpp"
+#include "model.hpp"
+#include "model_loader.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// read only binary mesh file mapped into memory, the data stays valid as long as the object lives
+class MappedMesh {
+public:
+  // map the file, throws std::logic_error if it can not be opened or is no valid mesh file
+  explicit MappedMesh(std::string const& path);
+  // take the contents of a mesh file that only exists in memory
+  MappedMesh(std::vector<char>&& contents, std::string const& name);
+  MappedMesh(MappedMesh&& other);
+  MappedMesh(MappedMesh const&) = delete;
+  MappedMesh& operator=(MappedMesh const&) = delete;
+
+  model::attrib_flag_t getAttributes() const;
+  // byte offsets of the attributes inside one vertex, as in model::offsets
+  std::map<model::attrib_flag_t, GLvoid*> const& getOffsets() const;
+  // size of one vertex in bytes, as in model::vertex_bytes
+  GLsizei getVertexBytes() const;
+  std::size_t getVertexCount() const;
+  // transforms restoring packed positions and texcoords, offset 0 and scale 1 for float vertices
+  mesh_processing::dequantization const& getDequantization() const;
+  std::size_t getIndexCount() const;
+
+  // interleaved vertex block, ready to be passed to glBufferData
+  void const* getVertices() const;
+  // indices in the format of getIndexFormat()
+  void const* getIndices() const;
+  // 16 bit indices for meshes with less than 65536 vertices, as chosen by model::index_format
+  model::attribute const& getIndexFormat() const;
+  // levels of detail inside the indices, empty if they only hold the full mesh
+  std::vector<model::lod> const& getLods() const;
+
+private:
+  // read the header and locate the blocks, throws std::logic_error if the contents are no valid mesh file
+  void initialize(std::string const& name);
+
+  // whole file in memory
+  MappedFile m_file;
+
+  model::attrib_flag_t m_attributes;
+  std::map<model::attrib_flag_t, GLvoid*> m_offsets;
+  GLsizei m_vertexBytes;
+  std::size_t m_vertexCount;
+  std::size_t m_indexCount;
+  mesh_processing::dequantization m_dequantization;
+  std::vector<model::lod> m_lods;
+  // byte offsets of the blocks from the file start
+  std::size_t m_vertexBlock;
+  std::size_t m_indexBlock;
+};
+
+namespace mesh_cache {
+
+// header at the start of a binary mesh file, followed by the level of detail table, the vertex and the index block
+struct header {
+  char magic[4];
+  std::uint32_t version;
+  // attributes requested when the source was loaded and the ones the vertices actually contain
+  std::uint32_t requested_attributes;
+  std::uint32_t attributes;
+  std::uint32_t vertex_bytes;
+  // model_loader processing steps applied before the model was written
+  std::uint32_t processing;
+  std::uint64_t vertex_count;
+  std::uint64_t index_count;
+  // size and modification time of the source file, a changed source invalidates the cache
+  std::uint64_t source_size;
+  std::int64_t source_time;
+  // transforms restoring packed positions and texcoords, offset 0 and scale 1 for float vertices
+  float position_offset[3];
+  float position_scale;
+  float texcoord_offset[2];
+  float texcoord_scale[2];
+  // entries of the level of detail table between the header and the vertex block
+  std::uint32_t lod_count;
+  std::uint32_t padding;
+};
+
+// entry of the level of detail table, as in model::lod
+struct lod_range {
+  std::uint32_t first_index;
+  std::uint32_t index_count;
+  float error;
+};
+
+// path of the cache file written for a source model
+std::string cache_path(std::string const& source_path);
+
+// contents of a binary mesh file holding the model, tagged with the source file and options it was loaded with
+// with model_loader::PACK_VERTICES the vertices are stored packed, unless the model can not be packed
+std::vector<char> serialize(model const& mdl, std::string const& source_path, model::attrib_flag_t requested_attributes,
+                            model_loader::process_flag_t processing = model_loader::NO_PROCESSING);
+
+// write the contents of a mesh file
+void write(std::string const& path, std::vector<char> const& contents);
+
+// write the model into a binary mesh file tagged with the source file and options it was loaded with
+void write(std::string const& path, model const& mdl, std::string const& source_path, model::attrib_flag_t requested_attributes,
+           model_loader::process_flag_t processing = model_loader::NO_PROCESSING);
+
+// check whether the cache file exists and belongs to the current version of the source file and the options
+bool is_current(std::string const& path, std::string const& source_path, model::attrib_flag_t requested_attributes,
+                model_loader::process_flag_t processing = model_loader::NO_PROCESSING);
+
+// map the cached mesh of an obj file, parsing the obj and writing the cache first if it is missing or outdated
+MappedMesh obj(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION,
+               model_loader::process_flag_t processing = model_loader::NO_PROCESSING);
+
+}
+
+#endif //OPENGL_FRAMEWORK_MESH_CACHE_HPP
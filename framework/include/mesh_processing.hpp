@@ -0,0 +1,61 @@
+#ifndef OPENGL_FRAMEWORK_MESH_PROCESSING_HPP
+#define OPENGL_FRAMEWORK_MESH_PROCESSING_HPP
+
+#include "model.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// optimizations applied to imported models before they are uploaded
+namespace mesh_processing {
+
+// vertex counts before and after welding
+struct weld_result {
+  std::size_t vertices_before;
+  std::size_t vertices_after;
+
+  // share of the vertices that was removed
+  double reduction() const;
+};
+
+// merge vertices whose interleaved attributes are identical and rewrite the indices to the merged vertices
+// models without indices are left unchanged, as they are drawn without an index buffer
+weld_result weld_vertices(model& mdl);
+
+// size of the simulated post transform vertex cache
+const std::size_t VERTEX_CACHE_SIZE = 32;
+
+// reorder the triangles so consecutive ones reuse the vertices in the post transform cache
+// uses tom forsyth's linear speed vertex cache optimisation, the indices must describe a triangle list
+void optimize_vertex_cache(std::vector<GLuint>& indices, std::size_t vertex_count);
+
+// reorder the vertices in the order the triangles first use them, so vertex fetches read memory linearly
+// vertices no triangle uses are removed, models without indices are left unchanged
+void optimize_vertex_fetch(model& mdl);
+
+// average cache miss ratio, the number of vertex shader runs per triangle with a fifo cache of the given size
+// ranges from 3 for no reuse down to about 0.5 for large regular meshes
+double acmr(std::vector<GLuint> const& indices, std::size_t cache_size = VERTEX_CACHE_SIZE);
+
+// collapse edges in the order of their quadric error until at most target_index_count indices are left
+// vertices are only moved onto their neighbours, so the result indexes the vertices of the model
+// vertices on seams and open borders stay in place, so the simplification may end above the target
+// returns the largest collapse error, as an estimate of the distance to the original surface in model units
+float simplify(model const& mdl, std::vector<GLuint> const& indices, std::size_t target_index_count, std::vector<GLuint>& result);
+
+// restores packed positions as offset + position * scale, one scale for all axes keeps normal matrices valid
+// texcoords are restored the same way per axis, so repeating texcoords outside [0, 1] survive packing
+struct dequantization {
+  GLfloat offset[3];
+  GLfloat scale;
+  GLfloat texcoord_offset[2];
+  GLfloat texcoord_scale[2];
+};
+
+// convert the vertices to the formats of model::PACKED_VERTEX_ATTRIBS and write the transforms restoring them
+// returns false and leaves the arguments unchanged for models without positions
+bool pack_vertices(model const& mdl, std::vector<char>& packed, dequantization& restore);
+
+}
+
+#endif //OPENGL_FRAMEWORK_MESH_PROCESSING_HPP
@@ -2,7 +2,9 @@
 #define MODEL_HPP
 
 #include <glbinding/gl/types.h>
+#include <glbinding/gl/boolean.h>
 
+#include <cstddef>
 #include <map>
 #include <vector>
 // use gl definitions from glbinding 
@@ -16,13 +18,17 @@ struct model {
   // type holding info about a vertex/model attribute
   struct attribute {
 
-    attribute(attrib_flag_t f, GLsizei s, GLsizei c, GLenum t)
+    attribute(attrib_flag_t f, GLsizei s, GLsizei c, GLenum t, GLboolean n = GL_FALSE)
      :flag{f}
      ,size{s}
      ,components{c}
      ,type{t}
+     ,normalized{n}
     {}
 
+    // size of one element in bytes, packed types hold all components in one word of the given size
+    GLsizei bytes() const;
+
     // conversion to flag type for use as enum
     operator attrib_flag_t const&() const{
       return flag;
@@ -36,6 +42,8 @@ struct model {
     GLint components;
     // Gl type
     GLenum type;
+    // whether integer components are mapped to [0, 1] or [-1, 1] when read by the shader
+    GLboolean normalized;
     // offset from element beginning
     GLvoid* offset;
   };
@@ -50,12 +58,36 @@ struct model {
   static attribute const& BITANGENT;
   // is not a vertex attribute, so not stored in VERTEX_ATTRIBS
   static attribute const  INDEX;
-  
+  // 16 bit indices, used instead of INDEX for models with less than 65536 vertices
+  static attribute const  SHORT_INDEX;
+  // smallest index format able to address the given number of vertices
+  static attribute const& index_format(std::size_t vertex_count);
+  // compact formats of the vertex attributes, in the same order and with the same flags as VERTEX_ATTRIBS
+  // positions are normalized shorts inside the model bounds, directions 10 bit per component and texcoords normalized ushorts
+  static std::vector<attribute> const PACKED_VERTEX_ATTRIBS;
+  // marks vertices stored in the formats of PACKED_VERTEX_ATTRIBS, is no attribute itself
+  static attrib_flag_t const PACKED;
+
+  // attribute formats used by vertices with the given attributes
+  static std::vector<attribute> const& vertex_attribs(attrib_flag_t contained_attributes);
+  // write the byte offsets of the contained attributes and return the size of one vertex in bytes
+  static GLsizei compute_offsets(attrib_flag_t contained_attributes, std::map<attrib_flag_t, GLvoid*>& offsets);
+
+  // range of indices drawing one level of detail, level 0 is the full mesh
+  struct lod {
+    std::size_t first_index;
+    std::size_t index_count;
+    // largest distance of the simplified surface from the full one, in model units
+    float error;
+  };
+
   model();
   model(std::vector<GLfloat> const& databuff, attrib_flag_t attribs, std::vector<GLuint> const& trianglebuff = std::vector<GLuint>{});
 
   std::vector<GLfloat> data;
   std::vector<GLuint> indices;
+  // levels of detail stored one after another in indices, empty if indices only hold the full mesh
+  std::vector<lod> lods;
   // byte offsets of individual element attributes
   std::map<attrib_flag_t, GLvoid*> offsets;
   // size of one vertex element in bytes
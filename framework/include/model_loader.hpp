@@ -1,13 +1,37 @@
 #ifndef MODEL_LOADER_HPP
 #define MODEL_LOADER_HPP
 
+#include "mesh_processing.hpp"
 #include "model.hpp"
 
 #include "tiny_obj_loader.h"
 
 namespace model_loader {
 
-model obj(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION);
+// optional processing steps applied after import, combined as flags
+typedef int process_flag_t;
+const process_flag_t NO_PROCESSING = 0;
+// merge identical vertices across shapes
+const process_flag_t WELD_VERTICES = 1 << 0;
+// reorder triangles and vertices with optimize()
+const process_flag_t OPTIMIZE = 1 << 1;
+// weigh the faces around a vertex by their corner angle instead of their area when generating missing normals
+const process_flag_t ANGLE_WEIGHTED_NORMALS = 1 << 2;
+// store the vertices of cached meshes in the formats of model::PACKED_VERTEX_ATTRIBS, obj() itself keeps floats
+const process_flag_t PACK_VERTICES = 1 << 3;
+// append simplified levels of detail to the indices with generate_lods(), applied after all other steps
+const process_flag_t GENERATE_LODS = 1 << 4;
+
+// the vertex counts of WELD_VERTICES are written to welded if given
+model obj(std::string const& path, model::attrib_flag_t import_attribs = model::POSITION, process_flag_t processing = NO_PROCESSING,
+          mesh_processing::weld_result* welded = nullptr);
+
+// reorder the triangles for the post transform vertex cache, then the vertices for linear fetches
+void optimize(model& mdl);
+
+// simplify the mesh into a chain of levels of detail with about half the triangles of the previous level each
+// the levels are appended to the indices and listed in model::lods, the chain ends early once seams stop the simplification
+void generate_lods(model& mdl);
 
 }
 
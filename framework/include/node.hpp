@@ -2,13 +2,17 @@
 #define OPENGL_FRAMEWORK_NODE_HPP
 
 #include <glm/glm.hpp>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <map>
 #include <functional>
 #include "structs.hpp"
 
-class Node {
+class TransformStore;
+class RenderQueue;
+
+class Node : public std::enable_shared_from_this<Node> {
 public:
   // constructor
   Node(std::string const& name);
@@ -30,21 +34,34 @@ public:
   glm::mat4 getLocalTransform();
   // set the local transform matrix of the node
   void setLocalTransform(glm::mat4 const& newTransform);
-  // get the world transform matrix of the node
+  // get the world transform matrix of the node, recomputed only if the node or one of its parents moved
   glm::mat4 getWorldTransform();
-  // set the world transform matrix of the node
+  // set the world transform matrix of the node by adapting its local transform
   void setWorldTransform(glm::mat4 const& newTransform);
+  // check if the world transform has to be recomputed
+  bool isDirty() const;
   // add a child node
   void addChild(std::shared_ptr<Node>);
   // remove a child node by name
   std::shared_ptr<Node> removeChild(std::string const& name);
-  virtual void render(std::map<std::string, shader_program> const& m_shaders, glm::mat4 const& view_transform);
+  // collect the subtree into a render queue and draw it sorted by state
+  void render(std::map<std::string, shader_program> const& m_shaders, glm::mat4 const& view_transform);
+  // add the draw items of the node and its subtree to the queue, nodes without geometry only visit their children
+  virtual void collect(RenderQueue& queue, std::map<std::string, shader_program> const& shaders, glm::mat4 const& view_transform);
+  // upload per draw uniforms and issue the draw call, the queue has bound shader, vertex array and texture
+  virtual void draw(shader_program const& shader);
   void iterate(std::function<void(std::shared_ptr<Node>)> func);
   void printGraph(std::ostream& os);
 
 private:
-  // parent node
-  std::shared_ptr<Node> m_parent;
+  // allow the store to attach nodes to its arrays
+  friend class TransformStore;
+
+  // flag the world transforms of this node and its subtree as outdated
+  void markDirty();
+
+  // parent node, weak to not keep parent and child alive mutually
+  std::weak_ptr<Node> m_parent;
   // map of child nodes
   std::map<std::string, std::shared_ptr<Node>> m_children;
   // name of the node
@@ -55,7 +72,13 @@ private:
   int m_depth;
   // local transform matrix of the node
   glm::mat4 m_localTransform;
-  // world transform matrix of the node
-  glm::mat4 m_globalTransform;
+  // cached world transform matrix of the node
+  glm::mat4 m_worldTransform;
+  // whether the cached world transform is outdated, atomic so nodes can be moved from parallel tasks
+  std::atomic<bool> m_isDirty;
+  // contiguous store holding the transforms instead, if the node is attached to one
+  TransformStore* m_store;
+  // index of the transforms in the store
+  std::size_t m_storeIndex;
 };
 #endif //OPENGL_FRAMEWORK_NODE_HPP
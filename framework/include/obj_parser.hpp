@@ -0,0 +1,23 @@
+#ifndef OPENGL_FRAMEWORK_OBJ_PARSER_HPP
+#define OPENGL_FRAMEWORK_OBJ_PARSER_HPP
+
+#include "tiny_obj_loader.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// obj parser working on the file in memory, chunks of lines are parsed in parallel
+namespace obj_parser {
+
+// parse obj contents into shapes split at group, object and material statements, as tinyobj::LoadObj does
+// vertices are unique per combination of position, texcoord and normal inside a shape, materials are ignored
+// throws std::logic_error if a face references a vertex attribute that does not exist
+std::vector<tinyobj::shape_t> parse(char const* data, std::size_t size);
+
+// map the obj file and parse it, throws std::logic_error if it can not be read
+std::vector<tinyobj::shape_t> load(std::string const& path);
+
+}
+
+#endif //OPENGL_FRAMEWORK_OBJ_PARSER_HPP
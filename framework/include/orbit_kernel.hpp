@@ -0,0 +1,34 @@
+#ifndef OPENGL_FRAMEWORK_ORBIT_KERNEL_HPP
+#define OPENGL_FRAMEWORK_ORBIT_KERNEL_HPP
+
+#include "planet.hpp"
+
+#include <vector>
+
+// orbit parameters of many bodies in separate arrays, so they can be evaluated several at once
+struct OrbitBatch {
+  // add the orbit of a planet, returns its index in the batch
+  std::size_t add(Planet const& planet);
+  // remove an orbit by moving the last one into its place
+  void removeSwap(std::size_t index);
+  void clear();
+  std::size_t size() const;
+
+  // semi-major axis of the orbit
+  std::vector<float> radius;
+  // duration of one orbit in seconds
+  std::vector<float> period;
+  // angle on the orbit at time 0 in radians
+  std::vector<float> phase;
+  std::vector<float> eccentricity;
+};
+
+namespace orbit_kernel {
+  // write orbit positions of the bodies [begin, end) at the given time to x and z, indexed from begin
+  // uses the widest instruction set enabled at compile time and matches Planet::orbitPosition
+  void evaluate(OrbitBatch const& orbits, double time, std::size_t begin, std::size_t end, float* x, float* z);
+  // name of the instruction set the kernel was compiled for
+  char const* instruction_set();
+}
+
+#endif //OPENGL_FRAMEWORK_ORBIT_KERNEL_HPP
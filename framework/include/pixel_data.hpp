@@ -3,6 +3,10 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
 
 // #include <glbinding/gl/types.h>
 #include <glbinding/gl/enum.h>
@@ -10,9 +14,14 @@
 using namespace gl;
 
 // holds texture data and format information
+// owns the pixel buffer, so it can only be moved and decoded images are passed on without copying them
 struct pixel_data {
+  // releases the buffer with the function of the allocator that created it
+  typedef void (*deleter_t)(void*);
+  typedef std::unique_ptr<std::uint8_t, deleter_t> buffer_t;
+
   pixel_data()
-   :pixels()
+   :pixels(nullptr, std::free)
    ,width{0}
    ,height{0}
    ,depth{0}
@@ -20,8 +29,9 @@ struct pixel_data {
    ,channel_type{GL_NONE}
   {}
 
-  pixel_data(std::vector<std::uint8_t> dat, GLenum c, GLenum ty, std::size_t w, std::size_t h = 1, std::size_t d = 1)
-   :pixels(dat)
+  // take ownership of a buffer allocated by a decoder, without copying it
+  pixel_data(buffer_t buffer, GLenum c, GLenum ty, std::size_t w, std::size_t h = 1, std::size_t d = 1)
+   :pixels(std::move(buffer))
    ,width{w}
    ,height{h}
    ,depth{d}
@@ -29,11 +39,30 @@ struct pixel_data {
    ,channel_type{ty}
   {}
 
+  // copy small buffers built in place, like placeholder pixels
+  pixel_data(std::vector<std::uint8_t> const& dat, GLenum c, GLenum ty, std::size_t w, std::size_t h = 1, std::size_t d = 1)
+   :pixels(static_cast<std::uint8_t*>(std::malloc(dat.size())), std::free)
+   ,width{w}
+   ,height{h}
+   ,depth{d}
+   ,channels{c}
+   ,channel_type{ty}
+  {
+    if (pixels && !dat.empty()) {
+      std::memcpy(pixels.get(), dat.data(), dat.size());
+    }
+  }
+
+  pixel_data(pixel_data&&) = default;
+  pixel_data& operator=(pixel_data&&) = default;
+  pixel_data(pixel_data const&) = delete;
+  pixel_data& operator=(pixel_data const&) = delete;
+
   void const* ptr() const {
-    return pixels.data();
+    return pixels.get();
   }
 
-  std::vector<std::uint8_t> pixels;
+  buffer_t pixels;
   std::size_t width;
   std::size_t height;
   std::size_t depth;
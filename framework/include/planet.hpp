@@ -1,16 +1,32 @@
 #ifndef OPENGL_FRAMEWORK_PLANET_HPP
 #define OPENGL_FRAMEWORK_PLANET_HPP
 
+#include <glm/glm.hpp>
+
+//newton iterations for kepler's equation, enough for the eccentricities of planets
+static const int KEPLER_ITERATIONS = 5;
+
 //struct to store planet information
 struct Planet {
   //scale of the planet model
   float diameter;
-  //distance from sun (or respective planet) that is being orbited
+  //distance from sun (or respective planet) that is being orbited, semi-major axis of elliptic orbits
   float orbitRadius;
   //duration for one orbit in seconds
   float orbitPeriod;
   //duration of rotation around self in seconds
   float rotationPeriod;
   glm::fvec3 color;
+  //eccentricity of the orbit ellipse, 0 for a circle
+  float eccentricity;
+  //angle on the orbit at time 0 in radians
+  float orbitPhase;
+
+  //position relative to the orbited body after the given simulation time in seconds
+  glm::fvec3 orbitPosition(double time) const;
+  //angle of rotation around self after the given simulation time in seconds
+  float rotationAngle(double time) const;
+  //transform of a unit circle around the origin onto the orbit ellipse
+  glm::fmat4 orbitEllipse() const;
 };
 #endif //OPENGL_FRAMEWORK_PLANET_HPP
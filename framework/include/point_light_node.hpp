@@ -6,7 +6,6 @@
 class PointLightNode : public Node {
 public:
   PointLightNode(std::string const &name, glm::fvec3 const& lightColor, float lightIntensity);
-  void render(std::map<std::string, shader_program> const& m_shaders, glm::mat4 const& view_transform) override;
   glm::vec3 const& getColor() const;
   float getIntensity() const;
 
@@ -0,0 +1,67 @@
+#ifndef OPENGL_FRAMEWORK_PROCEDURAL_MESH_HPP
+#define OPENGL_FRAMEWORK_PROCEDURAL_MESH_HPP
+
+#include "model.hpp"
+
+#include <cstddef>
+
+// parametric meshes built directly into a model, without reading files
+// the counts are constexpr, so buffers for a fixed tessellation can be sized at compile time
+namespace procedural_mesh {
+
+// uv sphere of radius one around the y axis, rings run from pole to pole and segments around the axis
+// the texcoords are equirectangular, u follows the longitude and v is one at the north pole
+constexpr std::size_t sphere_vertex_count(std::size_t rings, std::size_t segments) {
+  return (rings + 1) * (segments + 1);
+}
+// the triangles touching the poles are not doubled, so the first and last ring hold one per segment
+constexpr std::size_t sphere_index_count(std::size_t rings, std::size_t segments) {
+  return 6 * segments * (rings - 1);
+}
+
+// flat annulus in the xz plane facing +y, drawn as a triangle strip alternating inner and outer vertices
+constexpr std::size_t ring_vertex_count(std::size_t segments) {
+  return 2 * (segments + 1);
+}
+constexpr std::size_t ring_index_count(std::size_t segments) {
+  return ring_vertex_count(segments);
+}
+
+// unit circle in the xz plane, drawn as a line loop
+constexpr std::size_t orbit_vertex_count(std::size_t segments) {
+  return segments;
+}
+constexpr std::size_t orbit_index_count(std::size_t segments) {
+  return segments;
+}
+
+// cube from -1 to 1 with shared corners, drawn as a triangle list
+constexpr std::size_t cube_vertex_count() {
+  return 8;
+}
+constexpr std::size_t cube_index_count() {
+  return 36;
+}
+
+// coarsest tessellation a sphere level of detail is built with
+const std::size_t MIN_SPHERE_RINGS = 4;
+
+// sphere with positions and the requested normals, texcoords, tangents and bitangents
+// with lod_count above one, levels with half the rings and segments of the previous one are appended
+// to vertices and indices and listed in model::lods, until the level limit or MIN_SPHERE_RINGS is reached
+// throws std::logic_error for less than 2 rings or 3 segments
+model sphere(std::size_t rings, std::size_t segments, model::attrib_flag_t attribs = model::POSITION, std::size_t lod_count = 1);
+
+// ring between the radii with positions, normals and texcoords, u runs from 0 inside to 1 outside
+// and v from 0 to 1 around the ring
+model ring(std::size_t segments, float inner_radius, float outer_radius);
+
+// circle with positions only
+model orbit(std::size_t segments);
+
+// cube with positions only, as drawn around the camera for the skybox
+model cube();
+
+}
+
+#endif //OPENGL_FRAMEWORK_PROCEDURAL_MESH_HPP
@@ -0,0 +1,59 @@
+#ifndef OPENGL_FRAMEWORK_RENDER_QUEUE_HPP
+#define OPENGL_FRAMEWORK_RENDER_QUEUE_HPP
+
+#include "structs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Node;
+
+// state changes and draw calls of one submitted queue
+struct RenderStats {
+  std::size_t drawCalls = 0;
+  std::size_t programBinds = 0;
+  std::size_t vertexArrayBinds = 0;
+  std::size_t textureBinds = 0;
+  // binds skipped because the previous item already bound the same state
+  std::size_t programBindsAvoided = 0;
+  std::size_t vertexArrayBindsAvoided = 0;
+  std::size_t textureBindsAvoided = 0;
+};
+
+// flat list of draw items, collected from the scene graph and drawn sorted by state
+class RenderQueue {
+public:
+  RenderQueue();
+
+  // remove all items and reset the counters, keeps the storage for the next frame
+  void clear();
+  // queue a node to be drawn with the given state, depth is the distance to the camera
+  void add(Node& node, shader_program const& shader, GLuint vertexArray, texture_object const& texture, float depth);
+  // sort the items and draw them, binding only state that differs from the previous item
+  void submit();
+
+  std::size_t size() const;
+  RenderStats const& getStats() const;
+
+  // pixels covered by one unit at distance one from the camera, nodes use it to choose their level of detail
+  // 0 disables the selection, so all nodes draw their full mesh
+  void setLodScale(float pixelsPerUnit);
+  float getLodScale() const;
+
+private:
+  struct RenderItem {
+    // shader, texture, vertex array and depth from most to least significant bits
+    std::uint64_t key;
+    Node* node;
+    shader_program const* shader;
+    GLuint vertexArray;
+    texture_object texture;
+  };
+
+  std::vector<RenderItem> m_items;
+  RenderStats m_stats;
+  float m_lodScale;
+};
+
+#endif //OPENGL_FRAMEWORK_RENDER_QUEUE_HPP
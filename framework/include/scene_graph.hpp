@@ -4,8 +4,11 @@
 #include <string>
 #include <memory>
 #include <iostream>
+#include <vector>
 #include "node.hpp"
 #include "camera_node.hpp"
+#include "transform_store.hpp"
+#include "animation_system.hpp"
 
 class SceneGraph {
 public:
@@ -30,13 +33,43 @@ public:
     return m_root->printGraph(os);
   }
 
+  // keep all node transforms in contiguous arrays that are updated in one linear pass
+  void setTransformStoreEnabled(bool enabled) {
+    if (enabled) {
+      m_transforms.build(m_root);
+    } else {
+      m_transforms.clear();
+    }
+    m_isStoreEnabled = enabled;
+  }
+
+  TransformStore& getTransformStore() {
+    return m_transforms;
+  }
+
+  // components animating the nodes of the graph
+  AnimationSystem& getAnimations() {
+    return m_animations;
+  }
+
+  // animate all nodes and resolve their world transforms, subtrees are processed in parallel
+  // and nodes with many children split them further
+  void update(double dTime);
+
 private:
   SceneGraph() :
       m_name{"scene"},
-      m_root{std::make_shared<Node>("root")} {}
+      m_root{std::make_shared<Node>("root")},
+      m_transforms{},
+      m_isStoreEnabled{false},
+      m_animations{} {}
 
   std::string m_name;
   std::shared_ptr<Node> m_root;
+  // optional flat storage of the transforms, must be destroyed before the root
+  TransformStore m_transforms;
+  bool m_isStoreEnabled;
+  AnimationSystem m_animations;
 };
 
 
@@ -1,7 +1,11 @@
 #ifndef STRUCTS_HPP
 #define STRUCTS_HPP
 
+#include "model.hpp"
+
+#include <array>
 #include <map>
+#include <vector>
 #include <glbinding/gl/gl.h>
 // use gl definitions from glbinding 
 using namespace gl;
@@ -16,9 +20,18 @@ struct model_object {
   GLuint element_BO = 0;
   // primitive type to draw
   GLenum draw_mode = GL_NONE;
-  // indices number, if EBO exists
+  // indices number, if EBO exists, the number of the full level if the EBO holds levels of detail
   GLsizei num_elements = 0;
   bool has_indices = true;
+  // type of the indices in the EBO
+  GLenum index_type = GL_UNSIGNED_INT;
+  // index ranges of the levels of detail in the EBO, empty if it only holds the full mesh
+  std::vector<model::lod> lods;
+  // packed positions are restored as offset + position * scale, float positions keep the identity
+  std::array<GLfloat, 3> position_offset{{0.0f, 0.0f, 0.0f}};
+  GLfloat position_scale = 1.0f;
+  // offset and scale restoring packed texcoords, passed to the TexCoordTransform uniform
+  std::array<GLfloat, 4> texcoord_transform{{0.0f, 0.0f, 1.0f, 1.0f}};
 };
 
 // gpu representation of texture
@@ -29,12 +42,34 @@ struct texture_object {
   GLenum target = GL_TEXTURE_2D;
 };
 
+// uniforms set every draw, indexing their locations avoids name lookups while drawing
+// per frame values are shared by all programs through the FrameData block in frame_data.hpp
+enum uniform_id {
+  UNIFORM_MODEL_MATRIX = 0,
+  UNIFORM_NORMAL_MATRIX,
+  UNIFORM_COLOR,
+  UNIFORM_IS_NORMAL_MAP_ENABLED,
+  UNIFORM_TEXCOORD_TRANSFORM,
+  UNIFORM_TEXTURE_LAYER,
+  UNIFORM_COUNT
+};
+
+// name of the uniform in the shader sources
+inline char const* uniform_name(uniform_id id) {
+  static char const* const names[UNIFORM_COUNT] = {
+    "ModelMatrix", "NormalMatrix", "Color", "IsNormalMapEnabled", "TexCoordTransform", "TextureLayer"
+  };
+  return names[id];
+}
+
 // shader handle and uniform storage
 struct shader_program {
   shader_program(std::map<GLenum, std::string> paths)
    :shader_paths{paths}
    ,handle{0}
-   {}
+   {
+     u_handles.fill(-1);
+   }
 
   // paths to shader sources
   std::map<GLenum, std::string> shader_paths;
@@ -42,5 +77,7 @@ struct shader_program {
   GLuint handle;
   // uniform locations mapped to name
   std::map<std::string, GLint> u_locs{};
+  // locations of the requested uniforms indexed by uniform_id, -1 if not requested
+  std::array<GLint, UNIFORM_COUNT> u_handles;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef OPENGL_FRAMEWORK_TASK_SCHEDULER_HPP
+#define OPENGL_FRAMEWORK_TASK_SCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// thread pool where each worker has its own task queue and steals from the others when it runs empty
+class TaskScheduler {
+public:
+  // start the given number of worker threads
+  explicit TaskScheduler(unsigned workerCount);
+  // finish queued tasks and join the workers
+  ~TaskScheduler();
+  // prevent the shared instance from being copied
+  TaskScheduler(TaskScheduler const&) = delete;
+
+  // returns reference to static scheduler with one worker less than there are cores, the waiting thread helps out
+  static TaskScheduler& get();
+
+  // queue a task, tasks submitted by workers are put into their own queue
+  void submit(std::function<void()> task);
+  // queue a long task that must not run on the submitting thread, like decoding files in the background
+  // threads outside the pool only spread it over the worker queues, without workers it waits for wait()
+  void submitBackground(std::function<void()> task);
+  // run queued tasks on the calling thread until all submitted tasks are finished
+  void wait();
+  // split the range [0, count) into batches, process them in parallel and wait for them to finish
+  // the caller only helps with its own batches, so it is never held up by unrelated long tasks
+  void parallelFor(std::size_t count, std::size_t batchSize, std::function<void(std::size_t, std::size_t)> const& func);
+
+  unsigned getWorkerCount() const;
+
+private:
+  // batches of one parallelFor call
+  struct BatchGroup {
+    // batches still in a queue
+    std::atomic<std::size_t> queued;
+    // batches not finished yet
+    std::atomic<std::size_t> remaining;
+  };
+
+  struct Task {
+    std::function<void()> func;
+    // set for the batches of a parallelFor, null for submitted tasks
+    BatchGroup* group;
+  };
+
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop(unsigned index);
+  // queue of the calling worker, or the last queue for threads outside the pool
+  unsigned getQueueIndex() const;
+  // put a task into the queue of the calling worker, or distribute it if called from outside the pool
+  // background tasks of threads outside the pool skip their queue, which they drain while waiting
+  void enqueue(Task task, bool isBackground);
+  // take the newest task of the own queue or the oldest task of another queue, only batches of the group if one is given
+  bool takeTask(unsigned queueIndex, std::function<void()>& task, BatchGroup* group = nullptr);
+  void runTask(std::function<void()>& task);
+
+  // one queue per worker and one for threads outside the pool
+  std::vector<std::unique_ptr<WorkQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+  // queue that external submits are put into next
+  std::atomic<unsigned> m_nextQueue;
+  // tasks waiting in queues
+  std::atomic<int> m_queuedTasks;
+  // tasks that have been submitted but are not finished yet
+  std::atomic<int> m_pendingTasks;
+  bool m_isStopping;
+
+  std::mutex m_sleepMutex;
+  // wakes workers when tasks are queued
+  std::condition_variable m_taskQueued;
+  // wakes waiting threads when all tasks are done
+  std::condition_variable m_tasksDone;
+};
+
+#endif //OPENGL_FRAMEWORK_TASK_SCHEDULER_HPP
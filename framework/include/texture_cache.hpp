@@ -0,0 +1,89 @@
+#ifndef OPENGL_FRAMEWORK_TEXTURE_CACHE_HPP
+#define OPENGL_FRAMEWORK_TEXTURE_CACHE_HPP
+
+#include "mapped_file.hpp"
+#include "pixel_data.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// textures baked offline into a mip chain of 4x4 pixel blocks, stored next to their source image
+namespace texture_cache {
+
+// header at the start of a baked texture file, followed by the level table and the level blocks
+struct header {
+  char magic[4];
+  std::uint32_t version;
+  // GL_COMPRESSED_RGB_S3TC_DXT1_EXT for images without alpha, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT otherwise
+  std::uint32_t format;
+  std::uint32_t level_count;
+  // size and modification time of the source image, a changed source invalidates the baked file
+  std::uint64_t source_size;
+  std::int64_t source_time;
+};
+
+// entry of the level table, the offset counts from the file start
+struct level_range {
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+// bytes of one compressed 4x4 block, 8 for bc1 and 16 for bc3
+std::size_t block_bytes(GLenum format);
+
+// box filter the image to half its size in each dimension, at least one pixel
+pixel_data downsample(pixel_data const& image);
+
+// compress 8 bit rgb or rgba pixels into bc1 blocks, rows of blocks from the first pixel row on
+// blocks reaching past the image edges repeat the edge pixels
+std::vector<std::uint8_t> compress_bc1(pixel_data const& image);
+// compress 8 bit rgba pixels into bc3 blocks, an interpolated alpha block followed by a bc1 color block
+std::vector<std::uint8_t> compress_bc3(pixel_data const& image);
+
+// path of the baked file for a source image
+std::string cache_path(std::string const& source_path);
+
+// contents of a baked texture file with the mip chain of the image, tagged with the source file
+// throws std::logic_error for images that are not 8 bit rgb or rgba
+std::vector<char> serialize(pixel_data const& image, std::string const& source_path);
+
+// write the contents of a baked texture file
+void write(std::string const& path, std::vector<char> const& contents);
+
+// check whether the baked file exists and belongs to the current version of the source image
+bool is_current(std::string const& path, std::string const& source_path);
+
+}
+
+// read only baked texture file mapped into memory, the data stays valid as long as the object lives
+class MappedTexture {
+public:
+  // map the file, throws std::logic_error if it can not be opened or is no valid texture file
+  explicit MappedTexture(std::string const& path);
+  MappedTexture(MappedTexture&& other);
+  MappedTexture(MappedTexture const&) = delete;
+  MappedTexture& operator=(MappedTexture const&) = delete;
+
+  // block compressed internal format of all levels, as passed to glCompressedTexImage2D
+  GLenum getFormat() const;
+  // levels of the mip chain, level 0 is the full image and the last one is 1x1
+  std::size_t getLevelCount() const;
+  std::size_t getWidth(std::size_t level) const;
+  std::size_t getHeight(std::size_t level) const;
+  // compressed blocks of the level, ready to be passed to glCompressedTexImage2D
+  void const* getLevelData(std::size_t level) const;
+  std::size_t getLevelSize(std::size_t level) const;
+
+private:
+  // whole file in memory
+  MappedFile m_file;
+  GLenum m_format;
+  // dimensions and byte ranges of the levels
+  std::vector<texture_cache::level_range> m_levels;
+};
+
+#endif //OPENGL_FRAMEWORK_TEXTURE_CACHE_HPP
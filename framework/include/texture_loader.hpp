@@ -3,10 +3,13 @@
 
 #include "pixel_data.hpp"
 
+#include <cstddef>
 #include <string>
 
 namespace texture_loader {
   pixel_data file(std::string const& file_name, bool flipVertically);
+  // bilinear filtered copy of 8 bit pixels at another size, the corners of both images line up
+  pixel_data resize(pixel_data const& image, std::size_t width, std::size_t height);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef OPENGL_FRAMEWORK_TEXTURE_REGISTRY_HPP
+#define OPENGL_FRAMEWORK_TEXTURE_REGISTRY_HPP
+
+#include "structs.hpp"
+#include "texture_streamer.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// shares the textures of a streamer between everything loading the same files, so each file is decoded and uploaded once
+// textures are counted by the acquire calls returning them and deleted when the last of them is released
+class TextureRegistry {
+public:
+  explicit TextureRegistry(TextureStreamer& streamer);
+  // deletes the textures that are still acquired
+  ~TextureRegistry();
+  TextureRegistry(TextureRegistry const&) = delete;
+  TextureRegistry& operator=(TextureRegistry const&) = delete;
+
+  // texture of the file, loaded through the streamer on the first request
+  // the placeholder of the first request is kept until the image arrives
+  texture_object acquire(std::string const& fileName, std::array<std::uint8_t, 4> const& placeholder = {{128, 128, 128, 255}});
+  // cube map with one file per face, shared if all faces match
+  texture_object acquireCubeMap(std::vector<std::string> const& faceFiles);
+  // array texture with one file per layer, shared if all layers and the layer size match
+  texture_object acquireArray(std::vector<std::string> const& layerFiles, std::size_t width, std::size_t height);
+  // drop one reference of a texture returned by acquire, the last one deletes it
+  void release(texture_object const& texture);
+
+  // number of distinct textures held
+  std::size_t getTextureCount() const;
+  // references to a texture, 0 if it is not held
+  std::size_t getReferenceCount(texture_object const& texture) const;
+  // bytes of video memory held by the uploaded images of all textures
+  std::size_t getMemoryUsage() const;
+
+private:
+  // texture target and the canonical paths of its files, joined by new lines, arrays start with their layer size
+  typedef std::pair<GLenum, std::string> key_t;
+
+  struct Entry {
+    texture_object texture;
+    std::size_t references;
+    key_t key;
+  };
+
+  // count one more reference if the key is held already
+  bool addReference(key_t const& key, texture_object& texture);
+  void insert(key_t const& key, texture_object const& texture);
+
+  TextureStreamer& m_streamer;
+  std::map<GLuint, Entry> m_entries;
+  std::map<key_t, GLuint> m_handles;
+};
+
+#endif //OPENGL_FRAMEWORK_TEXTURE_REGISTRY_HPP
@@ -0,0 +1,110 @@
+#ifndef OPENGL_FRAMEWORK_TEXTURE_STREAMER_HPP
+#define OPENGL_FRAMEWORK_TEXTURE_STREAMER_HPP
+
+#include "pixel_data.hpp"
+#include "structs.hpp"
+#include "task_scheduler.hpp"
+#include "texture_cache.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// decodes image files on the task scheduler while the textures already exist with a placeholder
+// only the upload of the decoded pixels runs on the thread owning the gl context, when uploadFinished is called
+// images with a current baked file from texture_cache are mapped instead of decoded, if the driver supports its blocks
+class TextureStreamer {
+public:
+  explicit TextureStreamer(TaskScheduler& scheduler = TaskScheduler::get());
+  // waits for the decodes still running, their results are dropped
+  ~TextureStreamer();
+  TextureStreamer(TextureStreamer const&) = delete;
+  TextureStreamer& operator=(TextureStreamer const&) = delete;
+
+  // create a texture holding one pixel of the placeholder color and queue decoding the file into it
+  // the returned handle stays the same when the image arrives, so it can be given to nodes right away
+  texture_object load(std::string const& fileName, std::array<std::uint8_t, 4> const& placeholder = {{128, 128, 128, 255}});
+  // cube map with one file per face, in the order of the GL_TEXTURE_CUBE_MAP_POSITIVE_X based targets
+  // the map stays black until all faces arrived, as incomplete cube maps are sampled as black
+  texture_object loadCubeMap(std::vector<std::string> const& faceFiles);
+  // 2d array texture with one file per layer, each resized to the given size on the workers
+  // the array keeps the placeholder until all layers arrived and is then uploaded at once, failed layers stay black
+  // if every layer has a current baked file of the given size and one shared format, those are uploaded right away instead
+  texture_object loadArray(std::vector<std::string> const& layerFiles, std::size_t width, std::size_t height,
+                           std::array<std::uint8_t, 4> const& placeholder = {{128, 128, 128, 255}});
+
+  // upload the images decoded since the last call, called once per frame on the context thread
+  // rethrows the std::logic_error of a file that could not be decoded, returns the number of uploaded images
+  std::size_t uploadFinished();
+  // block until all queued images are decoded and uploaded
+  void finish();
+  // number of images queued but not yet uploaded
+  std::size_t getPendingCount() const;
+
+  // delete a texture created by load or loadCubeMap, decodes still running for it are dropped
+  // the handle is only deleted once they finished, so gl can not hand it out again in between
+  void unload(texture_object const& texture);
+  // bytes of video memory held by the uploaded images of a texture, including their mip levels
+  std::size_t getTextureBytes(GLuint handle) const;
+
+private:
+  // decoded image waiting for its upload
+  struct Decoded {
+    GLuint handle;
+    // GL_TEXTURE_2D, the cube map face or GL_TEXTURE_2D_ARRAY
+    GLenum target;
+    // layer of array textures
+    std::size_t layer;
+    pixel_data pixels;
+    // set instead of the pixels if the image was baked
+    std::unique_ptr<MappedTexture> baked;
+    // set instead of the pixels if decoding failed
+    std::exception_ptr error;
+  };
+
+  // layers of an array texture collected until the last one arrived
+  struct ArrayLayers {
+    std::size_t width;
+    std::size_t height;
+    std::vector<pixel_data> layers;
+  };
+
+  // decode on a worker, or right away if the scheduler has no workers to run it in the background
+  // images of array textures are resized to the size of their array
+  void queueDecode(std::string const& fileName, GLuint handle, GLenum target, std::size_t layer = 0,
+                   std::size_t width = 0, std::size_t height = 0);
+  // allocate the levels of an array texture and upload its collected layers
+  void uploadArray(GLuint handle);
+  // map the baked files of all layers and upload their blocks, false without changing the texture if one does not fit
+  bool uploadBakedArray(GLuint handle, std::vector<std::string> const& layerFiles, std::size_t width, std::size_t height);
+
+  TaskScheduler& m_scheduler;
+  // whether the context can sample the s3tc blocks of baked textures
+  bool m_isCompressionSupported;
+  mutable std::mutex m_mutex;
+  // signalled when a decode finishes
+  std::condition_variable m_decoded;
+  // completion queue, filled by the workers and drained by uploadFinished
+  std::vector<Decoded> m_finished;
+  // images queued and not yet uploaded, and the ones of them still being decoded
+  std::size_t m_pending;
+  std::size_t m_decoding;
+  // images queued and not yet uploaded per texture, only used on the context thread
+  std::map<GLuint, std::size_t> m_queued;
+  // unloaded textures waiting for their queued images before they are deleted
+  std::set<GLuint> m_unloaded;
+  // video memory of the uploaded images per texture
+  std::map<GLuint, std::size_t> m_textureBytes;
+  // array textures with layers still being decoded
+  std::map<GLuint, ArrayLayers> m_arrays;
+};
+
+#endif //OPENGL_FRAMEWORK_TEXTURE_STREAMER_HPP
@@ -0,0 +1,57 @@
+#ifndef OPENGL_FRAMEWORK_TRANSFORM_STORE_HPP
+#define OPENGL_FRAMEWORK_TRANSFORM_STORE_HPP
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class Node;
+
+// contiguous storage of all transforms of a node hierarchy, sorted in depth first order
+class TransformStore {
+public:
+  TransformStore();
+  // detach nodes before the store disappears
+  ~TransformStore();
+  // collect the hierarchy below root into flat arrays and attach the nodes to them
+  void build(std::shared_ptr<Node> const& root);
+  // detach all nodes, which then resolve their transforms on their own again
+  void clear();
+  // rebuild the arrays on next update because nodes were added or removed
+  void invalidate();
+  // number of stored transforms
+  std::size_t size() const;
+
+  // remove a node and its subtree from the store
+  void detach(Node& node);
+
+  // read transforms by their depth first index
+  glm::mat4 const& getLocalTransform(std::size_t index) const;
+  // get the world transform, updating outdated transforms first
+  glm::mat4 const& getWorldTransform(std::size_t index);
+  // access transforms of an attached node, local transforms are only written through the node
+  // so the node and the store never disagree and a rebuild cannot revert a change
+  void setLocalTransform(Node const& node, glm::mat4 const& transform);
+  glm::mat4 const& getWorldTransform(Node const& node);
+  // recompute all outdated world transforms in one linear pass
+  void update();
+
+private:
+  // assign indices to a node and its subtree
+  void insert(Node& node, int parent);
+  void setLocalTransform(std::size_t index, glm::mat4 const& transform);
+
+  // root of the stored hierarchy
+  std::weak_ptr<Node> m_root;
+  // index of the parent of each transform, -1 for the root
+  std::vector<int> m_parents;
+  std::vector<glm::mat4> m_localTransforms;
+  std::vector<glm::mat4> m_worldTransforms;
+  // first index whose world transform is outdated, all earlier ones are up to date
+  // atomic so local transforms of different nodes can be set from parallel tasks
+  std::atomic<std::size_t> m_firstDirty;
+  bool m_needsRebuild;
+};
+
+#endif //OPENGL_FRAMEWORK_TRANSFORM_STORE_HPP
@@ -12,16 +12,38 @@ using namespace gl;
 
 struct pixel_data;
 struct texture_object;
+struct model_object;
+struct model;
+class MappedMesh;
+class MappedTexture;
+struct shader_program;
 
 namespace utils {
-  // generate texture object from texture struct
+  // generate texture object from texture struct, the mip levels are generated by the driver
   texture_object create_texture_object(pixel_data const& tex);
+  // upload the block compressed mip chain of a baked texture into the texture bound to target, or into a cube map face
+  void upload_texture_levels(GLenum target, MappedTexture const& texture);
+  // generate texture object from a baked texture with its precomputed mip levels
+  texture_object create_texture_object(MappedTexture const& texture);
+  // upload model to vertex and index buffers, attributes are bound to their index in model::VERTEX_ATTRIBS
+  // packed vertices are converted to the formats of model::PACKED_VERTEX_ATTRIBS before the upload
+  model_object create_model_object(model const& mdl, GLenum draw_mode, bool pack_vertices = false);
+  // upload a cached mesh straight from its mapped file
+  model_object create_model_object(MappedMesh const& mesh, GLenum draw_mode);
+  // model space transform restoring packed positions, identity for objects with float positions
+  glm::fmat4 dequantization_matrix(model_object const& object);
   // print bound textures for all texture units
   void print_bound_textures();
 
   // get uniform location, throwing exception if name describes no active uniform variable
   GLint glGetUniformLocation(GLuint, const GLchar*);
 
+  // copy the locations of the uniforms known by uniform_id from the name map into the handle array
+  void update_uniform_handles(shader_program& program);
+
+  // attach the uniform block of the given name to a buffer binding point, programs without the block are skipped
+  void bind_uniform_block(GLuint program, GLchar const* name, GLuint binding);
+
   // test program for drawing validity
   void validate_program(GLuint program);
 
@@ -0,0 +1,137 @@
+#include "animation_system.hpp"
+#include "node.hpp"
+#include "task_scheduler.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// components per parallel task, small enough to balance but large enough to outweigh scheduling
+static const std::size_t BATCH_SIZE = 1024;
+
+AnimationSystem::AnimationSystem() :
+    m_time{0},
+    m_orbitNodes{},
+    m_orbitTargets{},
+    m_orbitBases{},
+    m_orbits{},
+    m_orbitX{},
+    m_orbitZ{},
+    m_spinNodes{},
+    m_spinTargets{},
+    m_spins{} {}
+
+void AnimationSystem::add(std::shared_ptr<Node> const& node, OrbitComponent const& component) {
+  if (component.motion == OrbitComponent::ORBIT) {
+    m_orbitNodes.push_back(node);
+    m_orbitTargets.push_back(node.get());
+    m_orbitBases.push_back(component.base);
+    m_orbits.add(component.planet);
+  } else {
+    m_spinNodes.push_back(node);
+    m_spinTargets.push_back(node.get());
+    m_spins.push_back(component);
+  }
+}
+
+void AnimationSystem::remove(Node const& node) {
+  for (std::size_t i = 0; i < m_orbitTargets.size();) {
+    if (m_orbitTargets[i] == &node) {
+      removeOrbit(i);
+    } else {
+      ++i;
+    }
+  }
+  for (std::size_t i = 0; i < m_spinTargets.size();) {
+    if (m_spinTargets[i] == &node) {
+      removeSpin(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void AnimationSystem::removeExpired() {
+  for (std::size_t i = 0; i < m_orbitNodes.size();) {
+    if (m_orbitNodes[i].expired()) {
+      removeOrbit(i);
+    } else {
+      ++i;
+    }
+  }
+  for (std::size_t i = 0; i < m_spinNodes.size();) {
+    if (m_spinNodes[i].expired()) {
+      removeSpin(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void AnimationSystem::removeOrbit(std::size_t index) {
+  // order does not matter, so fill the gap with the last component
+  m_orbitNodes[index] = std::move(m_orbitNodes.back());
+  m_orbitTargets[index] = m_orbitTargets.back();
+  m_orbitBases[index] = m_orbitBases.back();
+  m_orbits.removeSwap(index);
+  m_orbitNodes.pop_back();
+  m_orbitTargets.pop_back();
+  m_orbitBases.pop_back();
+}
+
+void AnimationSystem::removeSpin(std::size_t index) {
+  m_spinNodes[index] = std::move(m_spinNodes.back());
+  m_spinTargets[index] = m_spinTargets.back();
+  m_spins[index] = m_spins.back();
+  m_spinNodes.pop_back();
+  m_spinTargets.pop_back();
+  m_spins.pop_back();
+}
+
+void AnimationSystem::clear() {
+  m_orbitNodes.clear();
+  m_orbitTargets.clear();
+  m_orbitBases.clear();
+  m_orbits.clear();
+  m_spinNodes.clear();
+  m_spinTargets.clear();
+  m_spins.clear();
+}
+
+std::size_t AnimationSystem::size() const {
+  return m_orbitNodes.size() + m_spinNodes.size();
+}
+
+void AnimationSystem::update(double dTime) {
+  m_time += dTime;
+  double time = m_time;
+  // nodes cannot be destroyed during the update, so the raw pointers stay valid until it returns
+  removeExpired();
+  m_orbitX.resize(m_orbits.size());
+  m_orbitZ.resize(m_orbits.size());
+
+  // every component only depends on the time, so they can be evaluated in any order
+  TaskScheduler::get().parallelFor(m_orbits.size(), BATCH_SIZE, [this, time](std::size_t begin, std::size_t end) {
+    orbit_kernel::evaluate(m_orbits, time, begin, end, m_orbitX.data() + begin, m_orbitZ.data() + begin);
+
+    for (std::size_t i = begin; i < end; ++i) {
+      // translating only offsets the position column of the base transform
+      glm::fmat4 transform = m_orbitBases[i];
+      transform[3] += glm::fvec4(m_orbitX[i], 0, m_orbitZ[i], 0) * transform[3].w;
+      m_orbitTargets[i]->setLocalTransform(transform);
+    }
+  });
+  TaskScheduler::get().parallelFor(m_spins.size(), BATCH_SIZE, [this, time](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      OrbitComponent const& component = m_spins[i];
+      glm::fmat4 rotation = glm::rotate(glm::fmat4(1), component.planet.rotationAngle(time), glm::fvec3(0, 1, 0));
+      m_spinTargets[i]->setLocalTransform(rotation * component.base);
+    }
+  });
+}
+
+void AnimationSystem::setTime(double time) {
+  m_time = time;
+}
+
+double AnimationSystem::getTime() const {
+  return m_time;
+}
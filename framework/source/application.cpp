@@ -3,6 +3,7 @@
 #include "utils.hpp"
 #include "window_handler.hpp"
 #include "shader_loader.hpp"
+#include "frame_data.hpp"
 
 #include <glbinding/gl/gl.h>
 // use gl definitions from glbinding 
@@ -45,6 +46,10 @@ void Application::updateUniformLocations() {
       // store uniform location in map
       uniform.second = utils::glGetUniformLocation(pair.second.handle, uniform.first.c_str());
     }
+    // resolve the indexed locations used while drawing
+    utils::update_uniform_handles(pair.second);
+    // per frame data is read from the shared uniform buffer
+    utils::bind_uniform_block(pair.second.handle, "FrameData", FRAME_DATA_BINDING);
   }
 }
 
@@ -1,17 +1,30 @@
 
 #include "geometry_node.hpp"
+#include "render_queue.hpp"
+#include "utils.hpp"
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
 #include <iostream>
 
+//largest error of a level of detail in pixels before a finer level is drawn
+static const float LOD_PIXEL_ERROR = 1.0f;
+
 GeometryNode::GeometryNode(std::string const &name, model_object& geometry, glm::fvec3 color, std::string const& shader) :
     Node(name),
     m_geometry{geometry},
+    m_lod{0},
     m_texture{},
+    m_textureLayer{0},
     m_normalMap{},
     m_hasNormalMap{false},
     m_color{color},
-    m_shader{shader} {}
+    m_shader{shader},
+    m_isLit{shader == "planet"},
+    m_isSkybox{shader == "skybox"},
+    m_program{nullptr},
+    m_programSource{nullptr} {}
 
 //returns the geometry of the node
 model_object const& GeometryNode::getGeometry() {
@@ -21,10 +34,12 @@ model_object const& GeometryNode::getGeometry() {
 //sets the geometry handle object of the node
 void GeometryNode::setGeometry(model_object const& geometry) {
   m_geometry = geometry;
+  m_lod = 0;
 }
 
-void GeometryNode::setTexture(texture_object const& texture) {
+void GeometryNode::setTexture(texture_object const& texture, GLint layer) {
   m_texture = texture;
+  m_textureLayer = layer;
 }
 
 void GeometryNode::setNormalMap(texture_object const& normalMap) {
@@ -32,46 +47,79 @@ void GeometryNode::setNormalMap(texture_object const& normalMap) {
   m_hasNormalMap = true;
 }
 
-void GeometryNode::render(std::map<std::string, shader_program> const& shaders, glm::mat4 const& view_transform) {
-  // bind shader to which to upload uniforms
-  glUseProgram(shaders.at(m_shader).handle);
+shader_program const& GeometryNode::getProgram(std::map<std::string, shader_program> const& shaders) {
+  if (m_programSource != &shaders) {
+    m_program = &shaders.at(m_shader);
+    m_programSource = &shaders;
+  }
+  return *m_program;
+}
 
-  glm::fmat4 model_matrix = getWorldTransform();
-  //upload combined transformation matrices for geometry to the shader
-  glUniformMatrix4fv(shaders.at(m_shader).u_locs.at("ModelMatrix"), 1, GL_FALSE, glm::value_ptr(model_matrix));
+void GeometryNode::collect(RenderQueue& queue, std::map<std::string, shader_program> const& shaders, glm::mat4 const& view_transform) {
+  glm::fmat4 world_transform = getWorldTransform();
+  //distance along the view direction, used to draw front to back
+  float depth = -(view_transform * world_transform[3]).z;
+  m_lod = selectLod(world_transform, depth, queue.getLodScale());
+  queue.add(*this, getProgram(shaders), m_geometry.vertex_AO, m_texture, depth);
+  //continue with default behaviour, collect all children
+  Node::collect(queue, shaders, view_transform);
+}
 
-  //bind the VAO to draw
-  glBindVertexArray(m_geometry.vertex_AO);
+std::size_t GeometryNode::selectLod(glm::fmat4 const& world_transform, float depth, float lod_scale) const {
+  if (m_geometry.lods.empty() || lod_scale <= 0.f || depth <= 0.f) {
+    return 0;
+  }
+  //largest axis scale turns the model space errors into world space
+  float scale = std::max(glm::length(glm::fvec3{world_transform[0]}),
+                         std::max(glm::length(glm::fvec3{world_transform[1]}), glm::length(glm::fvec3{world_transform[2]})));
+  float pixels_per_unit = scale / depth * lod_scale;
+  std::size_t lod = 0;
 
-  if (m_shader == "planet") {
-    //activate 0th texture0
-    glActiveTexture(GL_TEXTURE0); //default anyway
-    glBindTexture(m_texture.target, m_texture.handle);
-    //upload 0th texture to shader
-    glUniform1i(shaders.at(m_shader).u_locs.at("Tex"), 0);
+  while (lod + 1 < m_geometry.lods.size() && m_geometry.lods[lod + 1].error * pixels_per_unit <= LOD_PIXEL_ERROR) {
+    ++lod;
+  }
+  return lod;
+}
+
+void GeometryNode::draw(shader_program const& shader) {
+  //packed vertices are restored to model space first
+  glm::fmat4 model_matrix = getWorldTransform() * utils::dequantization_matrix(m_geometry);
+  //upload combined transformation matrices for geometry to the shader
+  glUniformMatrix4fv(shader.u_handles[UNIFORM_MODEL_MATRIX], 1, GL_FALSE, glm::value_ptr(model_matrix));
+  glUniform4fv(shader.u_handles[UNIFORM_TEXCOORD_TRANSFORM], 1, m_geometry.texcoord_transform.data());
+  //nodes sharing an array texture only differ in their layer, so the render queue keeps them in one texture binding
+  glUniform1i(shader.u_handles[UNIFORM_TEXTURE_LAYER], m_textureLayer);
 
+  if (m_isLit) {
     //extra matrix for normal transformation to keep them orthogonal to surface
     glm::fmat4 normal_matrix = glm::inverseTranspose(model_matrix);
     //also transform normals
-    glUniformMatrix4fv(shaders.at(m_shader).u_locs.at("NormalMatrix"), 1, GL_FALSE, glm::value_ptr(normal_matrix));
+    glUniformMatrix4fv(shader.u_handles[UNIFORM_NORMAL_MATRIX], 1, GL_FALSE, glm::value_ptr(normal_matrix));
     //upload color
-    glUniform3fv(shaders.at(m_shader).u_locs.at("Color"), 1, glm::value_ptr(m_color));
+    glUniform3fv(shader.u_handles[UNIFORM_COLOR], 1, glm::value_ptr(m_color));
 
-    glUniform1i(shaders.at(m_shader).u_locs.at("IsNormalMapEnabled"), m_hasNormalMap ? 1 : 0);
+    glUniform1i(shader.u_handles[UNIFORM_IS_NORMAL_MAP_ENABLED], m_hasNormalMap ? 1 : 0);
   }
   if (m_hasNormalMap) {
+    //normal map sampler reads unit 1, the render queue binds textures to unit 0
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, m_normalMap.handle);
-    glUniform1i(shaders.at(m_shader).u_locs.at("NormalMap"), 1);
+    glActiveTexture(GL_TEXTURE0);
   }
   if (m_geometry.has_indices) {
-    glDrawElements(m_geometry.draw_mode, m_geometry.num_elements, model::INDEX.type, NULL);
+    GLsizei count = m_geometry.num_elements;
+    std::size_t first = 0;
+    //draw the index range of the selected level of detail
+    if (!m_geometry.lods.empty()) {
+      count = GLsizei(m_geometry.lods[m_lod].index_count);
+      first = m_geometry.lods[m_lod].first_index;
+    }
+    std::size_t index_bytes = m_geometry.index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    glDrawElements(m_geometry.draw_mode, count, m_geometry.index_type, (GLvoid*)(first * index_bytes));
   } else {
     glDrawArrays(m_geometry.draw_mode, 0, m_geometry.num_elements);
   }
-  if (m_shader == "skybox") {
+  if (m_isSkybox) {
     glClear(GL_DEPTH_BUFFER_BIT);
   }
-  //continue with default behaviour, render all children
-  Node::render(shaders, view_transform);
 }
@@ -0,0 +1,184 @@
+#include "instanced_geometry_node.hpp"
+#include "model.hpp"
+#include "render_queue.hpp"
+#include "task_scheduler.hpp"
+#include "utils.hpp"
+
+#include <glbinding/gl/gl.h>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstddef>
+
+// instances per parallel task when gathering transforms
+static const std::size_t BATCH_SIZE = 1024;
+
+InstancedGeometryNode::InstancedGeometryNode(std::string const& name, model_object const& geometry, std::string const& shader) :
+    Node(name),
+    m_geometry{geometry},
+    m_texture{},
+    m_shader{shader},
+    m_program{nullptr},
+    m_programSource{nullptr},
+    m_instances{},
+    m_instanceTargets{},
+    m_colors{},
+    m_layers{},
+    m_instanceData{},
+    m_instance_BO{0},
+    m_instanceCapacity{0} {}
+
+
+void InstancedGeometryNode::addInstance(std::shared_ptr<Node> const& node, glm::fvec3 const& color, GLint layer) {
+  m_instances.push_back(node);
+  m_instanceTargets.push_back(node.get());
+  m_colors.push_back(color);
+  m_layers.push_back(layer);
+}
+
+void InstancedGeometryNode::removeInstance(Node const& node) {
+  for (std::size_t i = 0; i < m_instanceTargets.size();) {
+    if (m_instanceTargets[i] == &node) {
+      eraseInstance(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void InstancedGeometryNode::eraseInstance(std::size_t index) {
+  // order does not matter, so fill the gap with the last instance
+  m_instances[index] = std::move(m_instances.back());
+  m_instanceTargets[index] = m_instanceTargets.back();
+  m_colors[index] = m_colors.back();
+  m_layers[index] = m_layers.back();
+  m_instances.pop_back();
+  m_instanceTargets.pop_back();
+  m_colors.pop_back();
+  m_layers.pop_back();
+}
+
+void InstancedGeometryNode::releaseBuffers() {
+  if (m_instance_BO != 0) {
+    glDeleteBuffers(1, &m_instance_BO);
+  }
+  m_instance_BO = 0;
+  m_instanceCapacity = 0;
+}
+
+std::size_t InstancedGeometryNode::getInstanceCount() const {
+  return m_instances.size();
+}
+
+model_object const& InstancedGeometryNode::getGeometry() {
+  return m_geometry;
+}
+
+void InstancedGeometryNode::setTexture(texture_object const& texture) {
+  m_texture = texture;
+}
+
+shader_program const& InstancedGeometryNode::getProgram(std::map<std::string, shader_program> const& shaders) {
+  if (m_programSource != &shaders) {
+    m_program = &shaders.at(m_shader);
+    m_programSource = &shaders;
+  }
+  return *m_program;
+}
+
+void InstancedGeometryNode::gatherInstances() {
+  // drop instances whose node has been destroyed
+  for (std::size_t i = 0; i < m_instances.size();) {
+    if (m_instances[i].expired()) {
+      eraseInstance(i);
+    } else {
+      ++i;
+    }
+  }
+  m_instanceData.resize(m_instances.size());
+
+  //packed vertices are restored to model space first
+  glm::fmat4 dequantization = utils::dequantization_matrix(m_geometry);
+
+  // world transforms are resolved by the scene graph update, so the tasks only read them
+  TaskScheduler::get().parallelFor(m_instanceData.size(), BATCH_SIZE, [this, &dequantization](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      glm::fmat4 modelMatrix = m_instanceTargets[i]->getWorldTransform() * dequantization;
+      m_instanceData[i].modelMatrix = modelMatrix;
+      //extra matrix for normal transformation to keep them orthogonal to surface
+      m_instanceData[i].normalMatrix = glm::inverseTranspose(glm::fmat3(modelMatrix));
+      m_instanceData[i].color = m_colors[i];
+      m_instanceData[i].layer = m_layers[i];
+    }
+  });
+}
+
+void InstancedGeometryNode::initializeInstanceBuffer() {
+  glGenBuffers(1, &m_instance_BO);
+  // instance attributes become part of the vertex array of the geometry, other shaders ignore their locations
+  glBindVertexArray(m_geometry.vertex_AO);
+  glBindBuffer(GL_ARRAY_BUFFER, m_instance_BO);
+
+  GLsizei stride = sizeof(InstanceData);
+  GLuint location = INSTANCE_LOCATION;
+  // matrices are passed as one vec4 or vec3 attribute per column
+  for (GLuint column = 0; column < 4; ++column, ++location) {
+    std::size_t offset = offsetof(InstanceData, modelMatrix) + column * sizeof(glm::fvec4);
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*) offset);
+    // advance once per instance instead of once per vertex
+    glVertexAttribDivisor(location, 1);
+  }
+  for (GLuint column = 0; column < 3; ++column, ++location) {
+    std::size_t offset = offsetof(InstanceData, normalMatrix) + column * sizeof(glm::fvec3);
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*) offset);
+    glVertexAttribDivisor(location, 1);
+  }
+  glEnableVertexAttribArray(location);
+  glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*) offsetof(InstanceData, color));
+  glVertexAttribDivisor(location, 1);
+  ++location;
+  // integer attribute, so the layer reaches the shader unconverted
+  glEnableVertexAttribArray(location);
+  glVertexAttribIPointer(location, 1, GL_INT, stride, (GLvoid*) offsetof(InstanceData, layer));
+  glVertexAttribDivisor(location, 1);
+}
+
+void InstancedGeometryNode::collect(RenderQueue& queue, std::map<std::string, shader_program> const& shaders, glm::mat4 const& view_transform) {
+  gatherInstances();
+
+  if (!m_instanceData.empty()) {
+    float depth = -(view_transform * getWorldTransform()[3]).z;
+    queue.add(*this, getProgram(shaders), m_geometry.vertex_AO, m_texture, depth);
+  }
+  //continue with default behaviour, collect all children
+  Node::collect(queue, shaders, view_transform);
+}
+
+void InstancedGeometryNode::draw(shader_program const& shader) {
+  if (m_instance_BO == 0) {
+    initializeInstanceBuffer();
+  }
+  // packed texcoords are restored by the shader
+  glUniform4fv(shader.u_handles[UNIFORM_TEXCOORD_TRANSFORM], 1, m_geometry.texcoord_transform.data());
+  glBindBuffer(GL_ARRAY_BUFFER, m_instance_BO);
+  GLsizeiptr size = GLsizeiptr(sizeof(InstanceData) * m_instanceData.size());
+
+  if (m_instanceData.size() > m_instanceCapacity) {
+    // grow the buffer to the new instance count
+    glBufferData(GL_ARRAY_BUFFER, size, m_instanceData.data(), GL_STREAM_DRAW);
+    m_instanceCapacity = m_instanceData.size();
+  } else {
+    // orphan the old storage, so the upload does not wait for the previous frame to be drawn
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(sizeof(InstanceData) * m_instanceCapacity), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, m_instanceData.data());
+  }
+  GLsizei instanceCount = GLsizei(m_instanceData.size());
+  // all instances in one draw call
+  if (m_geometry.has_indices) {
+    glDrawElementsInstanced(m_geometry.draw_mode, m_geometry.num_elements, m_geometry.index_type, NULL, instanceCount);
+  } else {
+    glDrawArraysInstanced(m_geometry.draw_mode, 0, m_geometry.num_elements, instanceCount);
+  }
+}
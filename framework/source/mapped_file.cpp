@@ -0,0 +1,139 @@
+#include "mapped_file.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define MAPPED_FILE_MMAP
+#endif
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+MappedFile::MappedFile(std::string const& path) :
+    m_data{nullptr},
+    m_size{0},
+    m_isMapped{false},
+    m_buffer{} {
+#if defined(MAPPED_FILE_MMAP)
+  int file = open(path.c_str(), O_RDONLY);
+  struct stat info;
+
+  if (file < 0 || fstat(file, &info) != 0) {
+    if (file >= 0) {
+      close(file);
+    }
+    throw std::logic_error("Could not open file " + path);
+  }
+  m_size = std::size_t(info.st_size);
+  // empty files can not be mapped, but are valid contents
+  if (m_size > 0) {
+    void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping keeps its own reference to the file
+    close(file);
+
+    if (mapping == MAP_FAILED) {
+      throw std::logic_error("Could not map file " + path);
+    }
+    m_data = static_cast<char const*>(mapping);
+    m_isMapped = true;
+  }
+  else {
+    close(file);
+  }
+#else
+  // no mmap available, read the whole file in one go instead
+  std::ifstream file{path, std::ios::binary | std::ios::ate};
+
+  if (!file) {
+    throw std::logic_error("Could not open file " + path);
+  }
+  m_buffer.resize(std::size_t(file.tellg()));
+  file.seekg(0);
+  file.read(m_buffer.data(), std::streamsize(m_buffer.size()));
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+#endif
+}
+
+MappedFile::MappedFile(std::vector<char>&& contents) :
+    m_data{nullptr},
+    m_size{0},
+    m_isMapped{false},
+    m_buffer{std::move(contents)} {
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+}
+
+MappedFile::MappedFile(MappedFile&& other) :
+    m_data{other.m_data},
+    m_size{other.m_size},
+    m_isMapped{other.m_isMapped},
+    m_buffer{std::move(other.m_buffer)} {
+  if (!m_isMapped) {
+    // moving the vector keeps its storage, but point at it explicitly
+    m_data = m_buffer.data();
+  }
+  // the other object no longer owns the mapping
+  other.m_data = nullptr;
+  other.m_size = 0;
+  other.m_isMapped = false;
+}
+
+MappedFile::~MappedFile() {
+  unmap();
+}
+
+void MappedFile::unmap() {
+#if defined(MAPPED_FILE_MMAP)
+  if (m_isMapped) {
+    munmap(const_cast<char*>(m_data), m_size);
+  }
+#endif
+  m_isMapped = false;
+}
+
+char const* MappedFile::getData() const {
+  return m_data;
+}
+
+std::size_t MappedFile::getSize() const {
+  return m_size;
+}
+
+namespace file_cache {
+
+bool file_stamp(std::string const& path, std::uint64_t& size, std::int64_t& time) {
+  struct stat info;
+
+  if (stat(path.c_str(), &info) != 0) {
+    return false;
+  }
+  size = std::uint64_t(info.st_size);
+  time = std::int64_t(info.st_mtime);
+  return true;
+}
+
+void write_atomic(std::string const& path, std::vector<char> const& contents) {
+  std::string temp_path = path + ".tmp";
+  {
+    std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+    file.write(contents.data(), std::streamsize(contents.size()));
+
+    if (!file) {
+      throw std::logic_error("Could not write file " + temp_path);
+    }
+  }
+  // rename does not replace existing files on windows
+  std::remove(path.c_str());
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    throw std::logic_error("Could not write file " + path);
+  }
+}
+
+}
@@ -0,0 +1,267 @@
+#include "mesh_cache.hpp"
+#include "model_loader.hpp"
+
+#include <glbinding/gl/enum.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+// increase when the layout of the file changes, older files are rewritten
+static const std::uint32_t VERSION = 4;
+static const char MAGIC[4] = {'M', 'E', 'S', 'H'};
+
+// check the header and that the file is large enough for the blocks it describes
+static bool is_valid(mesh_cache::header const& head, std::size_t file_size) {
+  if (std::memcmp(head.magic, MAGIC, sizeof(MAGIC)) != 0 || head.version != VERSION) {
+    return false;
+  }
+  std::uint64_t vertex_block = head.vertex_count * head.vertex_bytes;
+  std::uint64_t index_block = head.index_count * std::uint64_t(model::index_format(std::size_t(head.vertex_count)).size);
+  std::uint64_t lod_block = head.lod_count * std::uint64_t(sizeof(mesh_cache::lod_range));
+  return sizeof(mesh_cache::header) + lod_block + vertex_block + index_block <= file_size;
+}
+
+MappedMesh::MappedMesh(std::string const& path) :
+    m_file{path},
+    m_attributes{0},
+    m_offsets{},
+    m_vertexBytes{0},
+    m_vertexCount{0},
+    m_indexCount{0},
+    m_dequantization{{0.0f, 0.0f, 0.0f}, 1.0f, {0.0f, 0.0f}, {1.0f, 1.0f}},
+    m_lods{},
+    m_vertexBlock{sizeof(mesh_cache::header)},
+    m_indexBlock{0} {
+  initialize(path);
+}
+
+MappedMesh::MappedMesh(std::vector<char>&& contents, std::string const& name) :
+    m_file{std::move(contents)},
+    m_attributes{0},
+    m_offsets{},
+    m_vertexBytes{0},
+    m_vertexCount{0},
+    m_indexCount{0},
+    m_dequantization{{0.0f, 0.0f, 0.0f}, 1.0f, {0.0f, 0.0f}, {1.0f, 1.0f}},
+    m_lods{},
+    m_vertexBlock{sizeof(mesh_cache::header)},
+    m_indexBlock{0} {
+  initialize(name);
+}
+
+MappedMesh::MappedMesh(MappedMesh&& other) :
+    m_file{std::move(other.m_file)},
+    m_attributes{other.m_attributes},
+    m_offsets{std::move(other.m_offsets)},
+    m_vertexBytes{other.m_vertexBytes},
+    m_vertexCount{other.m_vertexCount},
+    m_indexCount{other.m_indexCount},
+    m_dequantization(other.m_dequantization),
+    m_lods{std::move(other.m_lods)},
+    m_vertexBlock{other.m_vertexBlock},
+    m_indexBlock{other.m_indexBlock} {}
+
+void MappedMesh::initialize(std::string const& name) {
+  mesh_cache::header head{};
+
+  if (m_file.getSize() >= sizeof(head)) {
+    std::memcpy(&head, m_file.getData(), sizeof(head));
+  }
+  if (m_file.getSize() < sizeof(head) || !is_valid(head, m_file.getSize())) {
+    throw std::logic_error("Invalid mesh file " + name);
+  }
+  m_attributes = model::attrib_flag_t(head.attributes);
+  m_vertexBytes = model::compute_offsets(m_attributes, m_offsets);
+  m_vertexCount = std::size_t(head.vertex_count);
+  m_indexCount = std::size_t(head.index_count);
+  std::memcpy(m_dequantization.offset, head.position_offset, sizeof(head.position_offset));
+  m_dequantization.scale = head.position_scale;
+  std::memcpy(m_dequantization.texcoord_offset, head.texcoord_offset, sizeof(head.texcoord_offset));
+  std::memcpy(m_dequantization.texcoord_scale, head.texcoord_scale, sizeof(head.texcoord_scale));
+  // levels of detail are copied out of the table, as the nodes keep them with the geometry
+  for (std::size_t i = 0; i < head.lod_count; ++i) {
+    mesh_cache::lod_range range{};
+    std::memcpy(&range, m_file.getData() + sizeof(head) + i * sizeof(range), sizeof(range));
+    m_lods.push_back(model::lod{range.first_index, range.index_count, range.error});
+  }
+  m_vertexBlock = sizeof(head) + head.lod_count * sizeof(mesh_cache::lod_range);
+  m_indexBlock = m_vertexBlock + m_vertexCount * std::size_t(m_vertexBytes);
+}
+
+model::attrib_flag_t MappedMesh::getAttributes() const {
+  return m_attributes;
+}
+
+std::map<model::attrib_flag_t, GLvoid*> const& MappedMesh::getOffsets() const {
+  return m_offsets;
+}
+
+GLsizei MappedMesh::getVertexBytes() const {
+  return m_vertexBytes;
+}
+
+std::size_t MappedMesh::getVertexCount() const {
+  return m_vertexCount;
+}
+
+mesh_processing::dequantization const& MappedMesh::getDequantization() const {
+  return m_dequantization;
+}
+
+std::size_t MappedMesh::getIndexCount() const {
+  return m_indexCount;
+}
+
+void const* MappedMesh::getVertices() const {
+  return m_file.getData() + m_vertexBlock;
+}
+
+void const* MappedMesh::getIndices() const {
+  // blocks are 4 byte aligned, as the header size and the vertex size are multiples of 4
+  return m_file.getData() + m_indexBlock;
+}
+
+model::attribute const& MappedMesh::getIndexFormat() const {
+  return model::index_format(m_vertexCount);
+}
+
+std::vector<model::lod> const& MappedMesh::getLods() const {
+  return m_lods;
+}
+
+namespace mesh_cache {
+
+std::string cache_path(std::string const& source_path) {
+  return source_path + ".mesh";
+}
+
+std::vector<char> serialize(model const& mdl, std::string const& source_path, model::attrib_flag_t requested_attributes,
+                            model_loader::process_flag_t processing) {
+  header head{};
+  std::memcpy(head.magic, MAGIC, sizeof(MAGIC));
+  head.version = VERSION;
+  head.requested_attributes = std::uint32_t(requested_attributes);
+  head.processing = std::uint32_t(processing);
+
+  for (auto const& pair : mdl.offsets) {
+    head.attributes |= std::uint32_t(pair.first);
+  }
+  head.vertex_bytes = std::uint32_t(mdl.vertex_bytes);
+  head.vertex_count = mdl.vertex_num;
+  head.index_count = mdl.indices.size();
+  head.position_scale = 1.0f;
+  head.texcoord_scale[0] = 1.0f;
+  head.texcoord_scale[1] = 1.0f;
+  // stamp of the source the model was just loaded from
+  file_cache::file_stamp(source_path, head.source_size, head.source_time);
+
+  void const* vertices = mdl.data.data();
+  std::size_t vertex_block = mdl.data.size() * sizeof(GLfloat);
+  std::vector<char> packed;
+  mesh_processing::dequantization restore{};
+
+  if ((processing & model_loader::PACK_VERTICES) && mesh_processing::pack_vertices(mdl, packed, restore)) {
+    std::map<model::attrib_flag_t, GLvoid*> offsets;
+    head.attributes |= std::uint32_t(model::PACKED);
+    head.vertex_bytes = std::uint32_t(model::compute_offsets(model::attrib_flag_t(head.attributes), offsets));
+    std::memcpy(head.position_offset, restore.offset, sizeof(head.position_offset));
+    head.position_scale = restore.scale;
+    std::memcpy(head.texcoord_offset, restore.texcoord_offset, sizeof(head.texcoord_offset));
+    std::memcpy(head.texcoord_scale, restore.texcoord_scale, sizeof(head.texcoord_scale));
+    vertices = packed.data();
+    vertex_block = packed.size();
+  }
+  // meshes with few vertices store 16 bit indices
+  model::attribute const& index_format = model::index_format(mdl.vertex_num);
+  std::vector<GLushort> short_indices;
+  void const* indices = mdl.indices.data();
+  std::size_t index_block = mdl.indices.size() * std::size_t(index_format.size);
+
+  if (index_format.type == GL_UNSIGNED_SHORT) {
+    short_indices.assign(mdl.indices.begin(), mdl.indices.end());
+    indices = short_indices.data();
+  }
+  std::vector<lod_range> lods;
+  for (model::lod const& level : mdl.lods) {
+    lods.push_back(lod_range{std::uint32_t(level.first_index), std::uint32_t(level.index_count), level.error});
+  }
+  head.lod_count = std::uint32_t(lods.size());
+
+  std::size_t lod_block = lods.size() * sizeof(lod_range);
+  std::vector<char> contents(sizeof(head) + lod_block + vertex_block + index_block);
+  char* block = contents.data();
+
+  std::memcpy(block, &head, sizeof(head));
+  block += sizeof(head);
+  if (lod_block > 0) {
+    std::memcpy(block, lods.data(), lod_block);
+    block += lod_block;
+  }
+  if (vertex_block > 0) {
+    std::memcpy(block, vertices, vertex_block);
+    block += vertex_block;
+  }
+  if (index_block > 0) {
+    std::memcpy(block, indices, index_block);
+  }
+  return contents;
+}
+
+void write(std::string const& path, std::vector<char> const& contents) {
+  file_cache::write_atomic(path, contents);
+}
+
+void write(std::string const& path, model const& mdl, std::string const& source_path, model::attrib_flag_t requested_attributes,
+           model_loader::process_flag_t processing) {
+  write(path, serialize(mdl, source_path, requested_attributes, processing));
+}
+
+bool is_current(std::string const& path, std::string const& source_path, model::attrib_flag_t requested_attributes,
+                model_loader::process_flag_t processing) {
+  std::ifstream file{path, std::ios::binary | std::ios::ate};
+
+  if (!file) {
+    return false;
+  }
+  std::size_t file_size = std::size_t(file.tellg());
+  header head{};
+  file.seekg(0);
+
+  if (!file.read(reinterpret_cast<char*>(&head), sizeof(head)) || !is_valid(head, file_size)) {
+    return false;
+  }
+  std::uint64_t source_size = 0;
+  std::int64_t source_time = 0;
+
+  // without the source the cache is all there is
+  if (!file_cache::file_stamp(source_path, source_size, source_time)) {
+    return true;
+  }
+  return head.requested_attributes == std::uint32_t(requested_attributes) &&
+         head.processing == std::uint32_t(processing) &&
+         head.source_size == source_size &&
+         head.source_time == source_time;
+}
+
+MappedMesh obj(std::string const& path, model::attrib_flag_t import_attribs, model_loader::process_flag_t processing) {
+  std::string mesh_path = cache_path(path);
+  model::attrib_flag_t requested = model::POSITION | import_attribs;
+
+  if (!is_current(mesh_path, path, requested, processing)) {
+    std::vector<char> contents = serialize(model_loader::obj(path, import_attribs, processing), path, requested, processing);
+
+    try {
+      write(mesh_path, contents);
+    }
+    catch (std::logic_error const& error) {
+      // read only resource directories can not hold the cache, so the obj is parsed every time
+      std::cerr << error.what() << ", using " << path << " uncached" << std::endl;
+      return MappedMesh{std::move(contents), mesh_path};
+    }
+  }
+  return MappedMesh{mesh_path};
+}
+
+}
@@ -0,0 +1,600 @@
+#include "mesh_processing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// marks empty slots of the hash table
+static const GLuint NO_VERTEX = ~GLuint(0);
+
+// weights of the vertex scores from tom forsyth's article
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+// valences above this share the score of the maximum
+static const std::size_t MAX_SCORED_VALENCE = 32;
+// marks vertices that are not in the cache and the missing best triangle
+static const int NOT_CACHED = -1;
+static const std::size_t NO_TRIANGLE = ~std::size_t(0);
+
+// fnv-1a over the bytes of the attributes, negative zero is hashed as zero so it matches positive zero
+// hashing whole words would leave the low bits equal for values with empty low mantissa bits, like whole numbers
+static std::uint32_t hash_vertex(GLfloat const* vertex, std::size_t floats) {
+  std::uint32_t hash = 2166136261u;
+
+  for (std::size_t i = 0; i < floats; ++i) {
+    GLfloat value = vertex[i] == 0.0f ? 0.0f : vertex[i];
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (std::size_t byte = 0; byte < sizeof(bits); ++byte) {
+      hash = (hash ^ ((bits >> (8 * byte)) & 0xFFu)) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+// collapses turning a triangle further than this are rejected, as cosine between the old and new normal
+static const double MIN_COLLAPSE_NORMAL_DOT = 0.2;
+
+// symmetric 4x4 matrix summing the squared distances to a set of planes, stored as its upper triangle
+// the number of planes turns the sum into a mean distance
+struct quadric {
+  double xx, xy, xz, xw, yy, yz, yw, zz, zw, ww;
+  double planes;
+};
+
+static void add_plane(quadric& q, double a, double b, double c, double d) {
+  q.xx += a * a; q.xy += a * b; q.xz += a * c; q.xw += a * d;
+  q.yy += b * b; q.yz += b * c; q.yw += b * d;
+  q.zz += c * c; q.zw += c * d;
+  q.ww += d * d;
+  q.planes += 1.0;
+}
+
+static quadric sum(quadric const& q, quadric const& r) {
+  return quadric{q.xx + r.xx, q.xy + r.xy, q.xz + r.xz, q.xw + r.xw, q.yy + r.yy,
+                 q.yz + r.yz, q.yw + r.yw, q.zz + r.zz, q.zw + r.zw, q.ww + r.ww, q.planes + r.planes};
+}
+
+// summed squared distance of the point to the planes
+static double evaluate(quadric const& q, GLfloat const* point) {
+  double x = point[0];
+  double y = point[1];
+  double z = point[2];
+  return q.xx * x * x + 2.0 * q.xy * x * y + 2.0 * q.xz * x * z + 2.0 * q.xw * x +
+         q.yy * y * y + 2.0 * q.yz * y * z + 2.0 * q.yw * y +
+         q.zz * z * z + 2.0 * q.zw * z + q.ww;
+}
+
+// unnormalized normal of the triangle
+static void triangle_normal(GLfloat const* a, GLfloat const* b, GLfloat const* c, double normal[3]) {
+  double u[3] = {double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2]};
+  double v[3] = {double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2]};
+  normal[0] = u[1] * v[2] - u[2] * v[1];
+  normal[1] = u[2] * v[0] - u[0] * v[2];
+  normal[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+// largest value of the normalized integer formats
+static const float SHORT_MAX = 32767.0f;
+static const float USHORT_MAX = 65535.0f;
+static const float TEN_BIT_MAX = 511.0f;
+
+// round a value in [-1, 1] to a normalized integer with the given maximum
+static int quantize(float value, float max) {
+  return int(std::lround(std::min(std::max(value, -1.0f), 1.0f) * max));
+}
+
+// three signed 10 bit components in the lower 30 bits, w stays 0 as directions do not read it
+static std::uint32_t pack_direction(GLfloat const* direction) {
+  std::uint32_t word = 0;
+  for (std::size_t i = 0; i < 3; ++i) {
+    word |= (std::uint32_t(quantize(direction[i], TEN_BIT_MAX)) & 0x3FFu) << (10 * i);
+  }
+  return word;
+}
+
+static bool is_equal(GLfloat const* a, GLfloat const* b, std::size_t floats) {
+  for (std::size_t i = 0; i < floats; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace mesh_processing {
+
+double weld_result::reduction() const {
+  return vertices_before > 0 ? 1.0 - double(vertices_after) / double(vertices_before) : 0.0;
+}
+
+weld_result weld_vertices(model& mdl) {
+  weld_result result{mdl.vertex_num, mdl.vertex_num};
+
+  if (mdl.indices.empty() || mdl.vertex_num == 0) {
+    return result;
+  }
+  std::size_t floats = std::size_t(mdl.vertex_bytes) / sizeof(GLfloat);
+  // open addressing table with at most half of the slots in use
+  std::size_t table_size = 1;
+  while (table_size < mdl.vertex_num * 2) {
+    table_size *= 2;
+  }
+  std::vector<GLuint> table(table_size, NO_VERTEX);
+  std::vector<GLuint> remap(mdl.vertex_num);
+  GLuint vertex_count = 0;
+
+  for (std::size_t i = 0; i < mdl.vertex_num; ++i) {
+    GLfloat const* vertex = &mdl.data[i * floats];
+    std::size_t slot = hash_vertex(vertex, floats) & (table_size - 1);
+
+    // probe until the vertex or an empty slot is found
+    while (table[slot] != NO_VERTEX && !is_equal(&mdl.data[table[slot] * floats], vertex, floats)) {
+      slot = (slot + 1) & (table_size - 1);
+    }
+    if (table[slot] == NO_VERTEX) {
+      // unique vertices are moved to the front, they never overtake the vertex being read
+      if (vertex_count != i) {
+        std::memmove(&mdl.data[vertex_count * floats], vertex, floats * sizeof(GLfloat));
+      }
+      table[slot] = vertex_count++;
+    }
+    remap[i] = table[slot];
+  }
+
+  for (GLuint& index : mdl.indices) {
+    index = remap[index];
+  }
+  mdl.data.resize(vertex_count * floats);
+  mdl.vertex_num = vertex_count;
+  result.vertices_after = vertex_count;
+
+  return result;
+}
+
+void optimize_vertex_cache(std::vector<GLuint>& indices, std::size_t vertex_count) {
+  std::size_t triangle_count = indices.size() / 3;
+
+  if (triangle_count == 0) {
+    return;
+  }
+  // scores by cache position and by number of triangles left, computed once
+  float cache_scores[VERTEX_CACHE_SIZE];
+  float valence_scores[MAX_SCORED_VALENCE + 1];
+
+  for (std::size_t i = 0; i < VERTEX_CACHE_SIZE; ++i) {
+    // the vertices of the last triangle get a fixed score, so it is not reused right away
+    cache_scores[i] = i < 3 ? LAST_TRIANGLE_SCORE : std::pow(1.0f - float(i - 3) / float(VERTEX_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+  }
+  valence_scores[0] = 0.0f;
+  for (std::size_t i = 1; i <= MAX_SCORED_VALENCE; ++i) {
+    // vertices with few triangles left are preferred, so they leave the working set early
+    valence_scores[i] = VALENCE_BOOST_SCALE * std::pow(float(i), -VALENCE_BOOST_POWER);
+  }
+  auto score = [&](int cache_position, std::size_t remaining) {
+    if (remaining == 0) {
+      return -1.0f;
+    }
+    float result = valence_scores[std::min(remaining, MAX_SCORED_VALENCE)];
+    return cache_position == NOT_CACHED ? result : result + cache_scores[cache_position];
+  };
+
+  // triangles of each vertex, the ones not emitted yet are kept at the front of each range
+  std::vector<std::size_t> first_triangle(vertex_count + 1, 0);
+  for (GLuint index : indices) {
+    ++first_triangle[index + 1];
+  }
+  for (std::size_t i = 0; i < vertex_count; ++i) {
+    first_triangle[i + 1] += first_triangle[i];
+  }
+  std::vector<std::size_t> vertex_triangles(indices.size());
+  std::vector<std::size_t> remaining(vertex_count, 0);
+
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    GLuint vertex = indices[i];
+    vertex_triangles[first_triangle[vertex] + remaining[vertex]++] = i / 3;
+  }
+
+  std::vector<int> cache_position(vertex_count, NOT_CACHED);
+  std::vector<float> vertex_score(vertex_count);
+  for (std::size_t i = 0; i < vertex_count; ++i) {
+    vertex_score[i] = score(NOT_CACHED, remaining[i]);
+  }
+  std::vector<float> triangle_score(triangle_count);
+  std::vector<char> is_emitted(triangle_count, 0);
+  std::size_t best_triangle = 0;
+
+  for (std::size_t i = 0; i < triangle_count; ++i) {
+    triangle_score[i] = vertex_score[indices[i * 3]] + vertex_score[indices[i * 3 + 1]] + vertex_score[indices[i * 3 + 2]];
+    best_triangle = triangle_score[i] > triangle_score[best_triangle] ? i : best_triangle;
+  }
+
+  std::vector<GLuint> ordered;
+  ordered.reserve(indices.size());
+  // the emitted triangle is put in front, the vertices pushed past the cache size drop out
+  std::vector<GLuint> cache;
+  std::vector<GLuint> next_cache;
+  // input order is used to continue when no cached vertex has triangles left
+  std::size_t next_unemitted = 0;
+
+  while (ordered.size() < indices.size()) {
+    if (best_triangle == NO_TRIANGLE) {
+      while (is_emitted[next_unemitted]) {
+        ++next_unemitted;
+      }
+      best_triangle = next_unemitted;
+    }
+    GLuint const* triangle = &indices[best_triangle * 3];
+    is_emitted[best_triangle] = 1;
+    next_cache.assign(triangle, triangle + 3);
+
+    for (std::size_t i = 0; i < 3; ++i) {
+      GLuint vertex = triangle[i];
+      ordered.push_back(vertex);
+      // move the triangle behind the ones left to emit
+      std::size_t* begin = &vertex_triangles[first_triangle[vertex]];
+      std::size_t* last = begin + --remaining[vertex];
+      std::iter_swap(std::find(begin, last, best_triangle), last);
+    }
+    for (GLuint vertex : cache) {
+      if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+        next_cache.push_back(vertex);
+      }
+    }
+    // rescore the cached and evicted vertices and pass the change on to their triangles
+    best_triangle = NO_TRIANGLE;
+    float best_score = -1.0f;
+
+    for (std::size_t i = 0; i < next_cache.size(); ++i) {
+      GLuint vertex = next_cache[i];
+      cache_position[vertex] = i < VERTEX_CACHE_SIZE ? int(i) : NOT_CACHED;
+      float new_score = score(cache_position[vertex], remaining[vertex]);
+      float difference = new_score - vertex_score[vertex];
+      vertex_score[vertex] = new_score;
+
+      for (std::size_t j = first_triangle[vertex]; j < first_triangle[vertex] + remaining[vertex]; ++j) {
+        std::size_t candidate = vertex_triangles[j];
+        triangle_score[candidate] += difference;
+
+        if (triangle_score[candidate] > best_score) {
+          best_score = triangle_score[candidate];
+          best_triangle = candidate;
+        }
+      }
+    }
+    next_cache.resize(std::min(next_cache.size(), VERTEX_CACHE_SIZE));
+    cache.swap(next_cache);
+  }
+  indices.swap(ordered);
+}
+
+void optimize_vertex_fetch(model& mdl) {
+  if (mdl.indices.empty()) {
+    return;
+  }
+  std::size_t floats = std::size_t(mdl.vertex_bytes) / sizeof(GLfloat);
+  std::vector<GLuint> remap(mdl.vertex_num, NO_VERTEX);
+  std::vector<GLfloat> data;
+  data.reserve(mdl.data.size());
+
+  for (GLuint& index : mdl.indices) {
+    if (remap[index] == NO_VERTEX) {
+      remap[index] = GLuint(data.size() / floats);
+      data.insert(data.end(), mdl.data.begin() + std::ptrdiff_t(index * floats), mdl.data.begin() + std::ptrdiff_t((index + 1) * floats));
+    }
+    index = remap[index];
+  }
+  mdl.data.swap(data);
+  mdl.vertex_num = mdl.data.size() / floats;
+}
+
+double acmr(std::vector<GLuint> const& indices, std::size_t cache_size) {
+  if (indices.size() < 3) {
+    return 0.0;
+  }
+  // fifo cache as in most hardware, hits do not change the order
+  std::vector<GLuint> cache(cache_size, NO_VERTEX);
+  std::size_t next_slot = 0;
+  std::size_t misses = 0;
+
+  for (GLuint index : indices) {
+    if (std::find(cache.begin(), cache.end(), index) == cache.end()) {
+      cache[next_slot] = index;
+      next_slot = (next_slot + 1) % cache_size;
+      ++misses;
+    }
+  }
+  return double(misses) / double(indices.size() / 3);
+}
+
+// lowest and highest value of one attribute component over all vertices
+static void component_bounds(model const& mdl, std::size_t component, GLfloat& low, GLfloat& high) {
+  std::size_t floats = std::size_t(mdl.vertex_bytes) / sizeof(GLfloat);
+  low = mdl.data[component];
+  high = low;
+
+  for (std::size_t vertex = 1; vertex < mdl.vertex_num; ++vertex) {
+    low = std::min(low, mdl.data[vertex * floats + component]);
+    high = std::max(high, mdl.data[vertex * floats + component]);
+  }
+}
+
+bool pack_vertices(model const& mdl, std::vector<char>& packed, dequantization& restore) {
+  auto position = mdl.offsets.find(model::POSITION);
+
+  if (position == mdl.offsets.end() || mdl.vertex_num == 0) {
+    return false;
+  }
+  std::size_t floats = std::size_t(mdl.vertex_bytes) / sizeof(GLfloat);
+  // center and largest half extent of the bounds map the positions to [-1, 1]
+  dequantization bounds{{0.0f, 0.0f, 0.0f}, 0.0f, {0.0f, 0.0f}, {1.0f, 1.0f}};
+  for (std::size_t i = 0; i < 3; ++i) {
+    GLfloat low = 0.0f;
+    GLfloat high = 0.0f;
+    component_bounds(mdl, std::size_t(position->second) / sizeof(GLfloat) + i, low, high);
+    bounds.offset[i] = (low + high) * 0.5f;
+    bounds.scale = std::max(bounds.scale, (high - low) * 0.5f);
+  }
+  if (bounds.scale <= 0.0f) {
+    bounds.scale = 1.0f;
+  }
+  // texcoords are mapped from their bounds to [0, 1]
+  auto texcoord = mdl.offsets.find(model::TEXCOORD);
+  if (texcoord != mdl.offsets.end()) {
+    for (std::size_t i = 0; i < 2; ++i) {
+      GLfloat high = 0.0f;
+      component_bounds(mdl, std::size_t(texcoord->second) / sizeof(GLfloat) + i, bounds.texcoord_offset[i], high);
+      bounds.texcoord_scale[i] = high > bounds.texcoord_offset[i] ? high - bounds.texcoord_offset[i] : 1.0f;
+    }
+  }
+
+  model::attrib_flag_t attributes = model::PACKED;
+  for (auto const& pair : mdl.offsets) {
+    attributes |= pair.first;
+  }
+  std::map<model::attrib_flag_t, GLvoid*> offsets;
+  std::size_t packed_bytes = std::size_t(model::compute_offsets(attributes, offsets));
+  std::vector<char> vertices(mdl.vertex_num * packed_bytes);
+
+  for (std::size_t vertex = 0; vertex < mdl.vertex_num; ++vertex) {
+    GLfloat const* source = &mdl.data[vertex * floats];
+    char* target = &vertices[vertex * packed_bytes];
+
+    for (auto const& format : model::PACKED_VERTEX_ATTRIBS) {
+      auto offset = offsets.find(format);
+      if (offset == offsets.end()) {
+        continue;
+      }
+      GLfloat const* value = source + std::size_t(mdl.offsets.at(format)) / sizeof(GLfloat);
+      char* destination = target + std::size_t(offset->second);
+
+      if (format.flag == model::POSITION) {
+        GLshort coordinates[4] = {0, 0, 0, GLshort(SHORT_MAX)};
+        for (std::size_t i = 0; i < 3; ++i) {
+          coordinates[i] = GLshort(quantize((value[i] - bounds.offset[i]) / bounds.scale, SHORT_MAX));
+        }
+        std::memcpy(destination, coordinates, sizeof(coordinates));
+      } else if (format.flag == model::TEXCOORD) {
+        GLushort coordinates[2];
+        for (std::size_t i = 0; i < 2; ++i) {
+          coordinates[i] = GLushort(quantize((value[i] - bounds.texcoord_offset[i]) / bounds.texcoord_scale[i], USHORT_MAX));
+        }
+        std::memcpy(destination, coordinates, sizeof(coordinates));
+      } else {
+        std::uint32_t word = pack_direction(value);
+        std::memcpy(destination, &word, sizeof(word));
+      }
+    }
+  }
+  packed.swap(vertices);
+  restore = bounds;
+  return true;
+}
+
+float simplify(model const& mdl, std::vector<GLuint> const& indices, std::size_t target_index_count, std::vector<GLuint>& result) {
+  result = indices;
+  auto position_offset = mdl.offsets.find(model::POSITION);
+
+  if (position_offset == mdl.offsets.end() || mdl.vertex_num == 0) {
+    return 0.0f;
+  }
+  std::size_t floats = std::size_t(mdl.vertex_bytes) / sizeof(GLfloat);
+  std::size_t position_float = std::size_t(position_offset->second) / sizeof(GLfloat);
+  auto position = [&](GLuint vertex) {
+    return &mdl.data[vertex * floats + position_float];
+  };
+  std::size_t vertex_count = mdl.vertex_num;
+
+  // vertices sharing a position are the sides of a texture or normal seam, they share one quadric and stay in place
+  std::size_t table_size = 1;
+  while (table_size < vertex_count * 2) {
+    table_size *= 2;
+  }
+  std::vector<GLuint> table(table_size, NO_VERTEX);
+  std::vector<GLuint> canonical(vertex_count);
+  std::vector<char> locked(vertex_count, 0);
+
+  for (GLuint vertex = 0; vertex < GLuint(vertex_count); ++vertex) {
+    std::size_t slot = hash_vertex(position(vertex), 3) & (table_size - 1);
+
+    while (table[slot] != NO_VERTEX && !is_equal(position(table[slot]), position(vertex), 3)) {
+      slot = (slot + 1) & (table_size - 1);
+    }
+    if (table[slot] == NO_VERTEX) {
+      table[slot] = vertex;
+    } else {
+      locked[table[slot]] = 1;
+    }
+    canonical[vertex] = table[slot];
+  }
+
+  // edges used by a single triangle lie on an open border, moving their vertices would shrink the border
+  std::vector<std::uint64_t> edges;
+  edges.reserve(indices.size());
+  std::vector<quadric> quadrics(vertex_count, quadric{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    GLuint corners[3] = {canonical[indices[i]], canonical[indices[i + 1]], canonical[indices[i + 2]]};
+
+    for (std::size_t corner = 0; corner < 3; ++corner) {
+      GLuint a = std::min(corners[corner], corners[(corner + 1) % 3]);
+      GLuint b = std::max(corners[corner], corners[(corner + 1) % 3]);
+      edges.push_back(std::uint64_t(a) << 32 | b);
+    }
+    double normal[3];
+    triangle_normal(position(corners[0]), position(corners[1]), position(corners[2]), normal);
+    double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+    if (length > 0.0) {
+      GLfloat const* point = position(corners[0]);
+      double a = normal[0] / length;
+      double b = normal[1] / length;
+      double c = normal[2] / length;
+      double d = -(a * point[0] + b * point[1] + c * point[2]);
+
+      for (GLuint vertex : corners) {
+        add_plane(quadrics[vertex], a, b, c, d);
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  for (std::size_t i = 0; i < edges.size();) {
+    std::size_t end = i + 1;
+    while (end < edges.size() && edges[end] == edges[i]) {
+      ++end;
+    }
+    if (end - i == 1) {
+      locked[std::size_t(edges[i] >> 32)] = 1;
+      locked[std::size_t(edges[i] & 0xFFFFFFFFu)] = 1;
+    }
+    i = end;
+  }
+
+  // candidate edge collapse, moving one vertex onto the other
+  struct collapse {
+    double cost;
+    // mean squared distance to the planes, the error reported for the collapse
+    double error;
+    GLuint from;
+    GLuint to;
+  };
+  std::vector<collapse> collapses;
+  std::vector<std::size_t> first_triangle;
+  std::vector<std::size_t> vertex_triangles;
+  std::vector<char> touched(vertex_count);
+  std::vector<GLuint> remap(vertex_count);
+  double max_error = 0.0;
+
+  // each pass collapses edges in the order of their cost, edges whose ends were already moved wait for the next pass
+  while (result.size() > target_index_count) {
+    collapses.clear();
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+      // the neighbouring triangle lists each inner edge the other way round, so both directions are considered
+      for (std::size_t corner = 0; corner < 3; ++corner) {
+        GLuint a = result[i + corner];
+        GLuint b = result[i + (corner + 1) % 3];
+
+        if (!locked[canonical[a]]) {
+          quadric merged = sum(quadrics[canonical[a]], quadrics[canonical[b]]);
+          double cost = std::max(evaluate(merged, position(b)), 0.0);
+          collapses.push_back(collapse{cost, cost / std::max(merged.planes, 1.0), a, b});
+        }
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(), [](collapse const& a, collapse const& b) {
+      return a.cost < b.cost;
+    });
+
+    // triangles around each vertex
+    first_triangle.assign(vertex_count + 1, 0);
+    for (GLuint index : result) {
+      ++first_triangle[index + 1];
+    }
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex) {
+      first_triangle[vertex + 1] += first_triangle[vertex];
+    }
+    vertex_triangles.resize(result.size());
+    std::vector<std::size_t> fill(first_triangle.begin(), first_triangle.end() - 1);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      vertex_triangles[fill[result[i]]++] = i / 3;
+    }
+
+    std::fill(touched.begin(), touched.end(), 0);
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex) {
+      remap[vertex] = GLuint(vertex);
+    }
+    std::size_t triangle_count = result.size() / 3;
+    std::size_t collapsed = 0;
+
+    for (collapse const& candidate : collapses) {
+      if (triangle_count * 3 <= target_index_count) {
+        break;
+      }
+      if (touched[candidate.from] || touched[candidate.to]) {
+        continue;
+      }
+      // moving the vertex must not fold any remaining triangle over, earlier collapses of this pass are looked up in remap
+      bool flips = false;
+      std::size_t removed = 0;
+      for (std::size_t i = first_triangle[candidate.from]; i < first_triangle[candidate.from + 1] && !flips; ++i) {
+        GLuint const* corners = &result[vertex_triangles[i] * 3];
+        GLuint triangle[3] = {remap[corners[0]], remap[corners[1]], remap[corners[2]]};
+
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) {
+          continue;
+        }
+        if (triangle[0] == candidate.to || triangle[1] == candidate.to || triangle[2] == candidate.to) {
+          ++removed;
+          continue;
+        }
+        GLfloat const* before[3];
+        GLfloat const* after[3];
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+          before[corner] = position(triangle[corner]);
+          after[corner] = triangle[corner] == candidate.from ? position(candidate.to) : before[corner];
+        }
+        double normal_before[3];
+        double normal_after[3];
+        triangle_normal(before[0], before[1], before[2], normal_before);
+        triangle_normal(after[0], after[1], after[2], normal_after);
+        double dot = normal_before[0] * normal_after[0] + normal_before[1] * normal_after[1] + normal_before[2] * normal_after[2];
+        double lengths = std::sqrt((normal_before[0] * normal_before[0] + normal_before[1] * normal_before[1] + normal_before[2] * normal_before[2]) *
+                                   (normal_after[0] * normal_after[0] + normal_after[1] * normal_after[1] + normal_after[2] * normal_after[2]));
+        flips = !(dot > MIN_COLLAPSE_NORMAL_DOT * lengths);
+      }
+      if (flips) {
+        continue;
+      }
+      remap[candidate.from] = candidate.to;
+      quadrics[canonical[candidate.to]] = sum(quadrics[canonical[candidate.to]], quadrics[canonical[candidate.from]]);
+      // both ends are final for this pass, so remap never needs to be followed more than one step
+      touched[candidate.from] = touched[candidate.to] = 1;
+      triangle_count -= std::min(removed, triangle_count);
+      max_error = std::max(max_error, candidate.error);
+      ++collapsed;
+    }
+    if (collapsed == 0) {
+      break;
+    }
+    // apply the collapses and drop the triangles that lost their area
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+      GLuint a = remap[result[i]];
+      GLuint b = remap[result[i + 1]];
+      GLuint c = remap[result[i + 2]];
+
+      if (a != b && b != c && c != a) {
+        result[kept++] = a;
+        result[kept++] = b;
+        result[kept++] = c;
+      }
+    }
+    result.resize(kept);
+  }
+  return float(std::sqrt(max_error));
+}
+
+}
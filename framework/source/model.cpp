@@ -19,10 +19,31 @@ model::attribute const& model::TEXCOORD = model::VERTEX_ATTRIBS[2];
 model::attribute const& model::TANGENT = model::VERTEX_ATTRIBS[3];
 model::attribute const& model::BITANGENT = model::VERTEX_ATTRIBS[4];
 model::attribute const  model::INDEX{1 << 5, sizeof(unsigned),  1, GL_UNSIGNED_INT};
+model::attribute const  model::SHORT_INDEX{1 << 5, sizeof(GLushort),  1, GL_UNSIGNED_SHORT};
+
+std::vector<model::attribute> const model::PACKED_VERTEX_ATTRIBS
+ = {
+    // fourth component pads to 8 bytes and is always 1
+    /*POSITION*/{ 1 << 0, sizeof(GLshort), 4, GL_SHORT, GL_TRUE},
+    /*NORMAL*/{   1 << 1, sizeof(GLuint), 4, GL_INT_2_10_10_10_REV, GL_TRUE},
+    /*TEXCOORD*/{ 1 << 2, sizeof(GLushort), 2, GL_UNSIGNED_SHORT, GL_TRUE},
+    /*TANGENT*/{  1 << 3, sizeof(GLuint), 4, GL_INT_2_10_10_10_REV, GL_TRUE},
+    /*BITANGENT*/{1 << 4, sizeof(GLuint), 4, GL_INT_2_10_10_10_REV, GL_TRUE}
+ };
+
+model::attrib_flag_t const model::PACKED = 1 << 6;
+
+GLsizei model::attribute::bytes() const {
+  if (type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV) {
+    return size;
+  }
+  return size * components;
+}
 
 model::model()
  :data{}
  ,indices{}
+ ,lods{}
  ,offsets{}
  ,vertex_bytes{0}
  ,vertex_num{0}
@@ -31,24 +52,35 @@ model::model()
 model::model(std::vector<GLfloat> const& databuff, attrib_flag_t contained_attributes, std::vector<GLuint> const& trianglebuff)
  :data(databuff)
  ,indices(trianglebuff)
+ ,lods{}
  ,offsets{}
  ,vertex_bytes{0}
  ,vertex_num{0}
 {
-  // number of components per vertex
-  std::size_t component_num = 0;
+  vertex_bytes = compute_offsets(contained_attributes, offsets);
+  // set number of vertice sin buffer, all attributes are floats
+  vertex_num = data.size() * sizeof(GLfloat) / std::size_t(vertex_bytes);
+}
+
+model::attribute const& model::index_format(std::size_t vertex_count) {
+  return vertex_count <= 0xFFFF ? SHORT_INDEX : INDEX;
+}
+
+std::vector<model::attribute> const& model::vertex_attribs(attrib_flag_t contained_attributes) {
+  return contained_attributes & PACKED ? PACKED_VERTEX_ATTRIBS : VERTEX_ATTRIBS;
+}
+
+GLsizei model::compute_offsets(attrib_flag_t contained_attributes, std::map<attrib_flag_t, GLvoid*>& offsets) {
+  GLsizei vertex_bytes = 0;
 
-  for (auto const& supported_attribute : model::VERTEX_ATTRIBS) {
+  for (auto const& supported_attribute : vertex_attribs(contained_attributes)) {
     // check if buffer contains attribute
     if (supported_attribute.flag & contained_attributes) {
       // write offset, explicit cast to prevent narrowing warning
       offsets.insert(std::pair<attrib_flag_t, GLvoid*>{supported_attribute, (GLvoid*)uintptr_t(vertex_bytes)});
       // move offset pointer forward
-      vertex_bytes += supported_attribute.size * supported_attribute.components;
-      // increase number of components
-      component_num += supported_attribute.components;
+      vertex_bytes += supported_attribute.bytes();
     }
   }
-  // set number of vertice sin buffer
-  vertex_num = data.size() / component_num;
+  return vertex_bytes;
 }
\ No newline at end of file
@@ -1,31 +1,50 @@
 #include "model_loader.hpp"
+#include "mesh_processing.hpp"
+#include "obj_parser.hpp"
+#include "task_scheduler.hpp"
 
 // use floats and med precision operations
 #include <glm/gtc/type_precision.hpp>
+#include <glm/common.hpp>
 #include <glm/geometric.hpp>
 
+#include <cmath>
 #include <iostream>
 
-namespace model_loader {
-
-void generate_normals(tinyobj::mesh_t& model);
+// triangles and vertices per batch of the parallel normal and tangent loops
+static const std::size_t BATCH_SIZE = 4096;
+// limits of the level of detail chain
+static const std::size_t MAX_LOD_COUNT = 8;
+static const std::size_t MIN_LOD_TRIANGLES = 32;
+// a level must have at most this share of the previous level's triangles to be worth keeping
+static const double MAX_LOD_RATIO = 0.8;
+
+// triangle corners of each vertex, corners of vertex i are listed from first_corner[i] to first_corner[i + 1]
+// lets every vertex sum up its own triangles, so parallel loops over the vertices never write to the same vertex
+static void build_vertex_corners(std::vector<unsigned> const& indices, std::size_t vertex_count,
+                                 std::vector<std::size_t>& first_corner, std::vector<std::size_t>& vertex_corners) {
+  first_corner.assign(vertex_count + 1, 0);
+  for (unsigned index : indices) {
+    ++first_corner[index + 1];
+  }
+  for (std::size_t i = 0; i < vertex_count; ++i) {
+    first_corner[i + 1] += first_corner[i];
+  }
+  vertex_corners.resize(indices.size());
+  std::vector<std::size_t> filled(first_corner.begin(), first_corner.end() - 1);
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    vertex_corners[filled[indices[i]]++] = i;
+  }
+}
 
-std::vector<glm::fvec3> generate_tangents(tinyobj::mesh_t const& model);
+namespace model_loader {
 
-model obj(std::string const& name, model::attrib_flag_t import_attribs){
-  std::vector<tinyobj::shape_t> shapes;
-  std::vector<tinyobj::material_t> materials;
+void generate_normals(tinyobj::mesh_t& model, bool angle_weighted);
 
-  std::string err = tinyobj::LoadObj(shapes, materials, name.c_str());
+void generate_tangents(tinyobj::mesh_t const& model, std::vector<glm::fvec3>& tangents, std::vector<glm::fvec3>& bitangents);
 
-  if (!err.empty()) {
-    if (err[0] == 'W' && err[1] == 'A' && err[2] == 'R') {
-      std::cerr << "tinyobjloader: " << err << std::endl;    
-    }
-    else {
-      throw std::logic_error("tinyobjloader: " + err);    
-    }
-  }
+model obj(std::string const& name, model::attrib_flag_t import_attribs, process_flag_t processing, mesh_processing::weld_result* welded){
+  std::vector<tinyobj::shape_t> shapes = obj_parser::load(name);
 
   model::attrib_flag_t attributes{model::POSITION | import_attribs};
 
@@ -41,7 +60,7 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
     if(has_normals) {
       // generate normals if necessary
       if (curr_mesh.normals.empty()) {
-        generate_normals(curr_mesh);
+        generate_normals(curr_mesh, (processing & ANGLE_WEIGHTED_NORMALS) != 0);
       }
     }
 
@@ -49,21 +68,25 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
     if(has_uvs) {
       if (curr_mesh.texcoords.empty()) {
         has_uvs = false;
-        attributes ^= model::TEXCOORD;
+        attributes &= ~model::TEXCOORD;
         std::cerr << "Shape has no texcoords" << std::endl;
       }
     }
 
-    bool has_tangents = import_attribs & model::TANGENT;
+    bool has_tangents = (import_attribs & model::TANGENT) != 0;
+    bool has_bitangents = (import_attribs & model::BITANGENT) != 0;
     std::vector<glm::fvec3> tangents;
-    if (has_tangents) {
-      if (!has_uvs) {
+    std::vector<glm::fvec3> bitangents;
+    if (has_tangents || has_bitangents) {
+      // the tangent space follows the texture coordinates
+      if (curr_mesh.texcoords.empty()) {
         has_tangents = false;
-        attributes ^= model::TANGENT;
+        has_bitangents = false;
+        attributes &= ~(model::TANGENT | model::BITANGENT);
         std::cerr << "Shape has no texcoords" << std::endl;
       }
       else {
-        tangents = generate_tangents(curr_mesh);
+        generate_tangents(curr_mesh, tangents, bitangents);
       }
     }
 
@@ -89,6 +112,12 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
         vertex_data.push_back(tangents[i].y);
         vertex_data.push_back(tangents[i].z);
       }
+
+      if (has_bitangents) {
+        vertex_data.push_back(bitangents[i].x);
+        vertex_data.push_back(bitangents[i].y);
+        vertex_data.push_back(bitangents[i].z);
+      }
     }
 
     // add triangles
@@ -99,73 +128,198 @@ model obj(std::string const& name, model::attrib_flag_t import_attribs){
     vertex_offset += unsigned(curr_mesh.positions.size() / 3);
   }
 
-  return model{vertex_data, attributes, triangles};
+  model result{vertex_data, attributes, triangles};
+
+  if (processing & WELD_VERTICES) {
+    mesh_processing::weld_result vertex_counts = mesh_processing::weld_vertices(result);
+    if (welded != nullptr) {
+      *welded = vertex_counts;
+    }
+  }
+  // mesh_optimizer_benchmark reports the vertex cache efficiency, measuring it here would scan the indices twice more
+  if (processing & OPTIMIZE) {
+    optimize(result);
+  }
+  if (processing & GENERATE_LODS) {
+    generate_lods(result);
+  }
+  return result;
 }
 
-void generate_normals(tinyobj::mesh_t& model) {
-  std::vector<glm::fvec3> positions(model.positions.size() / 3);
+void optimize(model& mdl) {
+  mesh_processing::optimize_vertex_cache(mdl.indices, mdl.vertex_num);
+  mesh_processing::optimize_vertex_fetch(mdl);
+}
 
-  for (unsigned i = 0; i < model.positions.size(); i+=3) {
-    positions[i / 3] = glm::fvec3{model.positions[i], model.positions[i + 1], model.positions[i + 2]};
+void generate_lods(model& mdl) {
+  mdl.lods.clear();
+  if (mdl.indices.empty()) {
+    return;
   }
+  mdl.lods.push_back(model::lod{0, mdl.indices.size(), 0.0f});
+  std::vector<GLuint> previous_indices = mdl.indices;
 
-  std::vector<glm::fvec3> normals(model.positions.size() / 3, glm::fvec3{0.0f});
-  for (unsigned i = 0; i < model.indices.size(); i+=3) {
-    glm::fvec3 normal = glm::cross(positions[model.indices[i+1]] - positions[model.indices[i]], positions[model.indices[i+2]] - positions[model.indices[i]]);
+  // every level is simplified from the previous one, so its error adds to the error of the previous level
+  while (mdl.lods.size() < MAX_LOD_COUNT) {
+    model::lod const& previous = mdl.lods.back();
+    std::size_t target = previous.index_count / 6 * 3;
 
-    normals[model.indices[i]] += normal;
-    normals[model.indices[i+1]] += normal;
-    normals[model.indices[i+2]] += normal;
-  }
+    if (target < MIN_LOD_TRIANGLES * 3) {
+      break;
+    }
+    std::vector<GLuint> indices;
+    float error = mesh_processing::simplify(mdl, previous_indices, target, indices);
 
-  model.normals.reserve(model.positions.size());
-  for (unsigned i = 0; i < normals.size(); ++i) {
-    glm::fvec3 normal = glm::normalize(normals[i]);
-    model.normals[i * 3] = normal[0];
-    model.normals[i * 3 + 1] = normal[1];
-    model.normals[i * 3 + 2] = normal[2];
+    if (double(indices.size()) > double(previous.index_count) * MAX_LOD_RATIO) {
+      break;
+    }
+    previous_indices = indices;
+    mesh_processing::optimize_vertex_cache(indices, mdl.vertex_num);
+    model::lod level{mdl.indices.size(), indices.size(), previous.error + error};
+    mdl.indices.insert(mdl.indices.end(), indices.begin(), indices.end());
+    mdl.lods.push_back(level);
   }
 }
 
-std::vector<glm::fvec3> generate_tangents(tinyobj::mesh_t const& model) {
-  // containers for vertex attributes
-  std::vector<glm::fvec3> positions(model.positions.size() / 3);
-  std::vector<glm::fvec3> normals(model.positions.size() / 3);
-  std::vector<glm::fvec2> texcoords(model.positions.size() / 3);
-  std::vector<glm::fvec3> tangents(model.positions.size() / 3, glm::fvec3{0.0f});
-
-  // get vertex positions and texture coordinates from mesh_t
-  for (unsigned i = 0; i < model.positions.size(); i+=3) {
-    positions[i / 3] = glm::fvec3{model.positions[i],
-                                 model.positions[i + 1],
-                                 model.positions[i + 2]};
-    normals[i / 3] = glm::fvec3{model.normals[i],
-                                 model.normals[i + 1],
-                                 model.normals[i + 2]};
-  }
-  for (unsigned i = 0; i < model.texcoords.size(); i+=2) {
-    texcoords[i / 2] = glm::fvec2{model.texcoords[i], model.texcoords[i + 1]};
-  }
+void generate_normals(tinyobj::mesh_t& model, bool angle_weighted) {
+  std::size_t vertex_count = model.positions.size() / 3;
+  std::size_t triangle_count = model.indices.size() / 3;
+  // face normal of each triangle, its length is twice the triangle area
+  std::vector<glm::fvec3> face_normals(triangle_count);
+  // angle of each triangle corner, only filled for angle weighting
+  std::vector<float> corner_angles(angle_weighted ? model.indices.size() : 0);
+
+  TaskScheduler::get().parallelFor(triangle_count, BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      glm::fvec3 corners[3];
+      for (std::size_t j = 0; j < 3; ++j) {
+        float const* position = &model.positions[model.indices[i * 3 + j] * 3];
+        corners[j] = glm::fvec3{position[0], position[1], position[2]};
+      }
+      face_normals[i] = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
 
-  // calculate tangent for triangles
-  for (unsigned i = 0; i < model.indices.size() / 3; i++) {
-    // indices of vertices of this triangle
-    // unsigned indices[3] = {model.indices[i * 3],
-    //                        model.indices[i * 3 + 1],
-    //                        model.indices[i * 3 + 2]};
-    // access an attribute of xth vert with vector access "attribute[indices[x]]"
-    
-    // calculate tangent for the triangle and add it to the accumulation tangents of the adjacent vertices
-    // see generate_normals() for similar workflow 
-  }
-  // normalize and orthogonalize accumulated vertex tangents
-  for (unsigned i = 0; i < tangents.size(); ++i) {
-    // implement orthogonalization and normalization here
-  }
+      if (!angle_weighted) {
+        continue;
+      }
+      // the normal only gives the direction, the corner angle the weight
+      float length = glm::length(face_normals[i]);
+      face_normals[i] = length > 0.0f ? face_normals[i] / length : face_normals[i];
+
+      for (std::size_t j = 0; j < 3; ++j) {
+        glm::fvec3 edge1 = corners[(j + 1) % 3] - corners[j];
+        glm::fvec3 edge2 = corners[(j + 2) % 3] - corners[j];
+        float lengths = glm::length(edge1) * glm::length(edge2);
+        float cosine = lengths > 0.0f ? glm::dot(edge1, edge2) / lengths : 1.0f;
+        corner_angles[i * 3 + j] = std::acos(glm::clamp(cosine, -1.0f, 1.0f));
+      }
+    }
+  });
+
+  std::vector<std::size_t> first_corner;
+  std::vector<std::size_t> vertex_corners;
+  build_vertex_corners(model.indices, vertex_count, first_corner, vertex_corners);
+  model.normals.resize(vertex_count * 3);
+
+  TaskScheduler::get().parallelFor(vertex_count, BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      glm::fvec3 normal{0.0f};
 
-  throw std::logic_error("Tangent creation not implemented yet");
+      for (std::size_t j = first_corner[i]; j < first_corner[i + 1]; ++j) {
+        std::size_t corner = vertex_corners[j];
+        // without angle weighting larger triangles weigh more, as their normals are longer
+        normal += face_normals[corner / 3] * (angle_weighted ? corner_angles[corner] : 1.0f);
+      }
+      // vertices without triangles keep a zero normal
+      normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+      model.normals[i * 3] = normal.x;
+      model.normals[i * 3 + 1] = normal.y;
+      model.normals[i * 3 + 2] = normal.z;
+    }
+  });
+}
 
-  return tangents;
+void generate_tangents(tinyobj::mesh_t const& model, std::vector<glm::fvec3>& tangents, std::vector<glm::fvec3>& bitangents) {
+  std::size_t vertex_count = model.positions.size() / 3;
+  std::size_t triangle_count = model.indices.size() / 3;
+  // tangent space of each triangle, component arrays are written by independent batches
+  std::vector<float> tangent_x(triangle_count);
+  std::vector<float> tangent_y(triangle_count);
+  std::vector<float> tangent_z(triangle_count);
+  std::vector<float> bitangent_x(triangle_count);
+  std::vector<float> bitangent_y(triangle_count);
+  std::vector<float> bitangent_z(triangle_count);
+
+  TaskScheduler::get().parallelFor(triangle_count, BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      unsigned i0 = model.indices[i * 3];
+      unsigned i1 = model.indices[i * 3 + 1];
+      unsigned i2 = model.indices[i * 3 + 2];
+
+      // edges of the triangle in model and in texture space
+      float edge1_x = model.positions[i1 * 3] - model.positions[i0 * 3];
+      float edge1_y = model.positions[i1 * 3 + 1] - model.positions[i0 * 3 + 1];
+      float edge1_z = model.positions[i1 * 3 + 2] - model.positions[i0 * 3 + 2];
+      float edge2_x = model.positions[i2 * 3] - model.positions[i0 * 3];
+      float edge2_y = model.positions[i2 * 3 + 1] - model.positions[i0 * 3 + 1];
+      float edge2_z = model.positions[i2 * 3 + 2] - model.positions[i0 * 3 + 2];
+      float delta1_u = model.texcoords[i1 * 2] - model.texcoords[i0 * 2];
+      float delta1_v = model.texcoords[i1 * 2 + 1] - model.texcoords[i0 * 2 + 1];
+      float delta2_u = model.texcoords[i2 * 2] - model.texcoords[i0 * 2];
+      float delta2_v = model.texcoords[i2 * 2 + 1] - model.texcoords[i0 * 2 + 1];
+
+      // solve edge = tangent * delta_u + bitangent * delta_v, triangles without texture area contribute nothing
+      float determinant = delta1_u * delta2_v - delta2_u * delta1_v;
+      float factor = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+      tangent_x[i] = (edge1_x * delta2_v - edge2_x * delta1_v) * factor;
+      tangent_y[i] = (edge1_y * delta2_v - edge2_y * delta1_v) * factor;
+      tangent_z[i] = (edge1_z * delta2_v - edge2_z * delta1_v) * factor;
+      bitangent_x[i] = (edge2_x * delta1_u - edge1_x * delta2_u) * factor;
+      bitangent_y[i] = (edge2_y * delta1_u - edge1_y * delta2_u) * factor;
+      bitangent_z[i] = (edge2_z * delta1_u - edge1_z * delta2_u) * factor;
+    }
+  });
+
+  std::vector<std::size_t> first_corner;
+  std::vector<std::size_t> vertex_corners;
+  build_vertex_corners(model.indices, vertex_count, first_corner, vertex_corners);
+
+  tangents.assign(vertex_count, glm::fvec3{0.0f});
+  bitangents.assign(vertex_count, glm::fvec3{0.0f});
+  bool has_normals = model.normals.size() == model.positions.size();
+
+  TaskScheduler::get().parallelFor(vertex_count, BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      glm::fvec3 tangent{0.0f};
+      glm::fvec3 bitangent{0.0f};
+
+      for (std::size_t j = first_corner[i]; j < first_corner[i + 1]; ++j) {
+        std::size_t triangle = vertex_corners[j] / 3;
+        tangent += glm::fvec3{tangent_x[triangle], tangent_y[triangle], tangent_z[triangle]};
+        bitangent += glm::fvec3{bitangent_x[triangle], bitangent_y[triangle], bitangent_z[triangle]};
+      }
+      if (!has_normals) {
+        tangents[i] = glm::length(tangent) > 0.0f ? glm::normalize(tangent) : tangent;
+        bitangents[i] = glm::length(bitangent) > 0.0f ? glm::normalize(bitangent) : bitangent;
+        continue;
+      }
+      glm::fvec3 normal{model.normals[i * 3], model.normals[i * 3 + 1], model.normals[i * 3 + 2]};
+      // gram-schmidt orthogonalization against the normal
+      tangent -= normal * glm::dot(normal, tangent);
+
+      if (glm::length(tangent) < 1e-6f) {
+        // no usable texture direction, any vector perpendicular to the normal will do
+        tangent = glm::cross(normal, std::abs(normal.x) < 0.9f ? glm::fvec3{1.0f, 0.0f, 0.0f} : glm::fvec3{0.0f, 1.0f, 0.0f});
+      }
+      // degenerate input can have a zero normal, then the cross product is zero as well
+      tangent = glm::length(tangent) > 0.0f ? glm::normalize(tangent) : glm::fvec3{1.0f, 0.0f, 0.0f};
+      // mirrored texture coordinates flip the bitangent
+      float handedness = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+
+      tangents[i] = tangent;
+      bitangents[i] = glm::cross(normal, tangent) * handedness;
+    }
+  });
 }
 
 }
\ No newline at end of file
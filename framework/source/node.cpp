@@ -1,24 +1,29 @@
 #include "node.hpp"
+#include "transform_store.hpp"
+#include "render_queue.hpp"
 
 Node::Node(std::string const& name) :
-    m_parent{nullptr},
+    m_parent{},
     m_children{std::map<std::string, std::shared_ptr<Node>>{}},
     m_name{name},
     m_path{""},
     m_depth{0},
     m_localTransform{glm::mat4()},
-    m_globalTransform{glm::mat4()} {}
+    m_worldTransform{glm::mat4()},
+    m_isDirty{true},
+    m_store{nullptr},
+    m_storeIndex{0} {}
 
 std::shared_ptr<Node> Node::getParent() {
-  return m_parent;
+  return m_parent.lock();
 }
 
 void Node::setParent(std::shared_ptr<Node> node) {
   // set the parent of this node
   m_parent = node;
-  m_path = m_parent->getPath() + m_parent->getName();
-  // update global transform based on new parent and local transform
-  m_globalTransform = m_parent->getWorldTransform() * m_localTransform;
+  m_path = node ? node->getPath() + node->getName() : "";
+  // world transform now depends on the new parent
+  markDirty();
 }
 
 std::shared_ptr<Node> Node::getChild(std::string const& name) {
@@ -61,33 +66,59 @@ glm::mat4 Node::getLocalTransform() {
 void Node::setLocalTransform(const glm::mat4 &newTransform) {
   m_localTransform = newTransform;
 
-  for (auto& pair: m_children) {
-    // update global transform of children based on relative transform
-    pair.second->m_globalTransform = getWorldTransform();
+  if (m_store) {
+    // store recomputes world transforms in its next pass
+    m_store->setLocalTransform(*this, newTransform);
+    return;
   }
+  // only flag the subtree, world transforms are recomputed when they are requested
+  markDirty();
 }
 
 glm::mat4 Node::getWorldTransform() {
-  /* return the world transform of the node as a combination of global transform (mostly influenced by parent node)
-    and local transform */
-  return m_globalTransform * m_localTransform;
+  if (m_store) {
+    return m_store->getWorldTransform(*this);
+  }
+  if (m_isDirty) {
+    // combine the world transform of the parent with the local transform, parents resolve themselves the same way
+    std::shared_ptr<Node> parent = m_parent.lock();
+    m_worldTransform = parent ? parent->getWorldTransform() * m_localTransform : m_localTransform;
+    m_isDirty = false;
+  }
+  return m_worldTransform;
 }
 
 void Node::setWorldTransform(glm::mat4 const& newTransform) {
-  // set the new global transform
-  m_globalTransform = newTransform;
+  // calculate the local transform that results in the new world transform under the current parent
+  std::shared_ptr<Node> parent = m_parent.lock();
+  setLocalTransform(parent ? glm::inverse(parent->getWorldTransform()) * newTransform : newTransform);
+}
+
+bool Node::isDirty() const {
+  return m_isDirty;
+}
+
+void Node::markDirty() {
+  // a clean node always has clean parents, so the subtree of a dirty node is already dirty as well
+  if (m_isDirty.exchange(true)) {
+    return;
+  }
 
-  for (auto &pair: m_children) {
-    // update global transform of children
-    pair.second->m_globalTransform = getWorldTransform();
+  for (auto& pair : m_children) {
+    pair.second->markDirty();
   }
 }
 
 void Node::addChild(std::shared_ptr<Node> child) {
   //add node as child object that gets transformed with parent node together
   m_children.emplace(child->getName(), child);
-  child->m_globalTransform = getWorldTransform();
+  child->setParent(shared_from_this());
   child->m_depth = m_depth + 1;
+
+  if (m_store) {
+    // new child has to be sorted into the store
+    m_store->invalidate();
+  }
 }
 
 std::shared_ptr<Node> Node::removeChild(const std::string &name) {
@@ -97,18 +128,34 @@ std::shared_ptr<Node> Node::removeChild(const std::string &name) {
   if (iter != m_children.end()) {
     std::shared_ptr<Node> value = std::move(iter->second);
     m_children.erase(iter);
+
+    if (m_store) {
+      // removed subtree must not point into the store anymore
+      m_store->detach(*value);
+      m_store->invalidate();
+    }
+    // detached node is not transformed with this node anymore
+    value->setParent(nullptr);
     return value;
   }
   return nullptr;
 }
 
 void Node::render(std::map<std::string, shader_program> const& m_shaders, glm::mat4 const& view_transform) {
-  //render nothing by default and only call render on children
+  RenderQueue queue{};
+  collect(queue, m_shaders, view_transform);
+  queue.submit();
+}
+
+void Node::collect(RenderQueue& queue, std::map<std::string, shader_program> const& shaders, glm::mat4 const& view_transform) {
+  //draw nothing by default and only collect the children
   for (auto& pair : m_children) {
-    pair.second->render(m_shaders, view_transform);
+    pair.second->collect(queue, shaders, view_transform);
   }
 }
 
+void Node::draw(shader_program const&) {}
+
 void Node::iterate(std::function<void(std::shared_ptr<Node> node)> func) {
   //execute the passed function once with each child as parameter, then repeat down the node tree
   for (auto& pair : m_children) {
@@ -0,0 +1,535 @@
+#include "obj_parser.hpp"
+#include "mapped_file.hpp"
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+// smaller files are parsed by one thread, as splitting costs more than it saves
+static const std::size_t MIN_CHUNK_BYTES = 256 * 1024;
+// chunks per thread, so threads that finish early can steal the remaining ones
+static const std::size_t CHUNKS_PER_THREAD = 4;
+// marks table entries without a vertex
+static const unsigned NO_VERTEX = ~0u;
+
+// bits of corner components given relative to the end of the attribute list
+static const unsigned char RELATIVE_V = 1;
+static const unsigned char RELATIVE_VT = 2;
+static const unsigned char RELATIVE_VN = 4;
+
+// attribute indices of a face corner, zero based and -1 if not given
+struct corner {
+  int v;
+  int vt;
+  int vn;
+};
+
+static bool operator==(corner const& a, corner const& b) {
+  return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+}
+
+struct corner_hash {
+  std::size_t operator()(corner const& c) const {
+    return std::hash<std::uint64_t>{}(std::uint64_t(unsigned(c.v)) * 73856093u ^
+                                      std::uint64_t(unsigned(c.vt)) << 21 ^
+                                      std::uint64_t(unsigned(c.vn)) << 42);
+  }
+};
+
+// corner with negative indices, they can only be resolved once the preceding chunks are counted
+struct relative_corner {
+  std::size_t corner;
+  unsigned char components;
+};
+
+// group, object or material statement, the faces after it belong to a new shape
+struct shape_break {
+  // number of faces of the chunk before the statement
+  std::size_t face;
+  // material statements keep the name
+  bool renames;
+  std::string name;
+};
+
+// lines of the file parsed by one thread
+struct chunk {
+  char const* begin;
+  char const* end;
+
+  std::vector<float> positions;
+  std::vector<float> normals;
+  std::vector<float> texcoords;
+  std::vector<corner> corners;
+  // index of the first corner of each face
+  std::vector<std::size_t> face_starts;
+  std::vector<relative_corner> relatives;
+  std::vector<shape_break> breaks;
+};
+
+// consecutive faces of one chunk
+struct face_range {
+  std::size_t chunk;
+  std::size_t face_begin;
+  std::size_t face_end;
+};
+
+// faces of one shape, may span several chunks
+struct shape_faces {
+  std::string name;
+  std::vector<face_range> ranges;
+};
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t';
+}
+
+static bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static void skip_space(char const*& token, char const* end) {
+  while (token < end && is_space(*token)) {
+    ++token;
+  }
+}
+
+// the keyword must be followed by whitespace
+static bool is_keyword(char const* token, char const* end, char const* keyword, std::size_t length) {
+  return std::size_t(end - token) > length && std::memcmp(token, keyword, length) == 0 && is_space(token[length]);
+}
+
+// 10^exponent, exact up to 10^22
+static double power_of_ten(int exponent) {
+  static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  if (exponent >= 0 && exponent <= 22) {
+    return POWERS[exponent];
+  }
+  return std::pow(10.0, double(exponent));
+}
+
+// parse a decimal number with optional fraction and exponent, unreadable numbers are 0 as in tinyobj
+static float parse_float(char const*& token, char const* end) {
+  skip_space(token, end);
+  bool is_negative = false;
+
+  if (token < end && (*token == '-' || *token == '+')) {
+    is_negative = *token == '-';
+    ++token;
+  }
+  // 19 digits always fit, further ones only shift the exponent
+  std::uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+
+  for (; token < end && is_digit(*token); ++token) {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + std::uint64_t(*token - '0');
+      // leading zeros do not use up precision
+      digits += mantissa > 0 ? 1 : 0;
+    }
+    else {
+      ++exponent;
+    }
+  }
+  if (token < end && *token == '.') {
+    for (++token; token < end && is_digit(*token); ++token) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + std::uint64_t(*token - '0');
+        digits += mantissa > 0 ? 1 : 0;
+        --exponent;
+      }
+    }
+  }
+  if (token < end && (*token == 'e' || *token == 'E')) {
+    ++token;
+    bool is_negative_exponent = false;
+
+    if (token < end && (*token == '-' || *token == '+')) {
+      is_negative_exponent = *token == '-';
+      ++token;
+    }
+    int written = 0;
+    for (; token < end && is_digit(*token); ++token) {
+      // larger exponents over- or underflow anyway
+      written = std::min(written * 10 + (*token - '0'), 1000);
+    }
+    exponent += is_negative_exponent ? -written : written;
+  }
+  // skip whatever is left of the token
+  while (token < end && !is_space(*token)) {
+    ++token;
+  }
+  double value = exponent < 0 ? double(mantissa) / power_of_ten(-exponent) : double(mantissa) * power_of_ten(exponent);
+  return float(is_negative ? -value : value);
+}
+
+static int parse_int(char const*& token, char const* end) {
+  bool is_negative = false;
+
+  if (token < end && (*token == '-' || *token == '+')) {
+    is_negative = *token == '-';
+    ++token;
+  }
+  int value = 0;
+  for (; token < end && is_digit(*token); ++token) {
+    value = value * 10 + (*token - '0');
+  }
+  return is_negative ? -value : value;
+}
+
+// make the index zero based, negative indices count back from the attributes of the chunk read so far
+static int fix_index(int index, std::size_t count, unsigned char bit, unsigned char& relatives) {
+  if (index > 0) {
+    return index - 1;
+  }
+  if (index == 0) {
+    return 0;
+  }
+  relatives |= bit;
+  return int(count) + index;
+}
+
+// parse one of i, i/j, i//k and i/j/k
+static corner parse_corner(char const*& token, char const* end, chunk const& part, unsigned char& relatives) {
+  corner result{-1, -1, -1};
+  result.v = fix_index(parse_int(token, end), part.positions.size() / 3, RELATIVE_V, relatives);
+
+  if (token < end && *token == '/') {
+    ++token;
+
+    if (token < end && *token != '/') {
+      result.vt = fix_index(parse_int(token, end), part.texcoords.size() / 2, RELATIVE_VT, relatives);
+    }
+    if (token < end && *token == '/') {
+      ++token;
+      result.vn = fix_index(parse_int(token, end), part.normals.size() / 3, RELATIVE_VN, relatives);
+    }
+  }
+  // skip whatever is left of the token
+  while (token < end && !is_space(*token)) {
+    ++token;
+  }
+  return result;
+}
+
+// first whitespace separated word after the keyword
+static std::string parse_name(char const* token, char const* end) {
+  skip_space(token, end);
+  char const* name_end = token;
+
+  while (name_end < end && !is_space(*name_end)) {
+    ++name_end;
+  }
+  return std::string{token, name_end};
+}
+
+static void parse_line(char const* token, char const* end, chunk& part) {
+  skip_space(token, end);
+
+  if (token == end || *token == '#') {
+    return;
+  }
+  if (is_keyword(token, end, "v", 1)) {
+    token += 2;
+    for (int i = 0; i < 3; ++i) {
+      part.positions.push_back(parse_float(token, end));
+    }
+  }
+  else if (is_keyword(token, end, "vn", 2)) {
+    token += 3;
+    for (int i = 0; i < 3; ++i) {
+      part.normals.push_back(parse_float(token, end));
+    }
+  }
+  else if (is_keyword(token, end, "vt", 2)) {
+    token += 3;
+    for (int i = 0; i < 2; ++i) {
+      part.texcoords.push_back(parse_float(token, end));
+    }
+  }
+  else if (is_keyword(token, end, "f", 1)) {
+    token += 2;
+    part.face_starts.push_back(part.corners.size());
+    skip_space(token, end);
+
+    while (token < end) {
+      unsigned char relatives = 0;
+      corner result = parse_corner(token, end, part, relatives);
+
+      if (relatives != 0) {
+        part.relatives.push_back(relative_corner{part.corners.size(), relatives});
+      }
+      part.corners.push_back(result);
+      skip_space(token, end);
+    }
+  }
+  else if (is_keyword(token, end, "usemtl", 6)) {
+    part.breaks.push_back(shape_break{part.face_starts.size(), false, ""});
+  }
+  else if (is_keyword(token, end, "g", 1) || is_keyword(token, end, "o", 1)) {
+    part.breaks.push_back(shape_break{part.face_starts.size(), true, parse_name(token + 2, end)});
+  }
+  // other statements are not needed for the model
+}
+
+static void parse_chunk(chunk& part) {
+  char const* line = part.begin;
+
+  while (line < part.end) {
+    char const* line_end = static_cast<char const*>(std::memchr(line, '\n', std::size_t(part.end - line)));
+    char const* next_line = line_end ? line_end + 1 : part.end;
+    line_end = line_end ? line_end : part.end;
+
+    if (line_end > line && line_end[-1] == '\r') {
+      --line_end;
+    }
+    parse_line(line, line_end, part);
+    line = next_line;
+  }
+}
+
+// split the contents into chunks that end at line breaks
+static std::vector<chunk> split(char const* data, std::size_t size, std::size_t chunk_count) {
+  std::vector<chunk> chunks;
+  char const* end = data + size;
+  char const* begin = data;
+
+  for (std::size_t i = 1; i <= chunk_count && begin < end; ++i) {
+    char const* chunk_end = i == chunk_count ? end : data + size / chunk_count * i;
+    chunk_end = std::max(chunk_end, begin);
+    char const* line_end = static_cast<char const*>(std::memchr(chunk_end, '\n', std::size_t(end - chunk_end)));
+    chunk_end = line_end ? line_end + 1 : end;
+
+    chunks.emplace_back();
+    chunks.back().begin = begin;
+    chunks.back().end = chunk_end;
+    begin = chunk_end;
+  }
+  return chunks;
+}
+
+// the shapes are cut at the break statements, independent of the chunk boundaries
+static std::vector<shape_faces> collect_shapes(std::vector<chunk> const& chunks) {
+  std::vector<shape_faces> shapes;
+  shape_faces current{};
+
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    std::size_t face = 0;
+
+    for (shape_break const& statement : chunks[i].breaks) {
+      if (statement.face > face) {
+        current.ranges.push_back(face_range{i, face, statement.face});
+      }
+      face = statement.face;
+      std::string name = statement.renames ? statement.name : current.name;
+
+      if (!current.ranges.empty()) {
+        shapes.push_back(std::move(current));
+      }
+      current = shape_faces{name, {}};
+    }
+    if (chunks[i].face_starts.size() > face) {
+      current.ranges.push_back(face_range{i, face, chunks[i].face_starts.size()});
+    }
+  }
+  if (!current.ranges.empty()) {
+    shapes.push_back(std::move(current));
+  }
+  return shapes;
+}
+
+// attribute lists of the whole file
+struct attributes {
+  std::vector<float> positions;
+  std::vector<float> normals;
+  std::vector<float> texcoords;
+};
+
+// creates the vertices of one shape, unique per combination of indices
+class VertexWelder {
+public:
+  VertexWelder(attributes const& attribs, int first_position, int last_position, tinyobj::mesh_t& mesh) :
+      m_attributes(attribs),
+      m_firstPosition{first_position},
+      m_firstVertex(std::size_t(last_position - first_position + 1), NO_VERTEX),
+      m_corners{},
+      m_overflow{},
+      m_mesh(mesh) {}
+
+  // index of the vertex of the corner, false if the corner references a missing attribute
+  bool add(corner const& c, unsigned& index) {
+    if (c.v < 0 || std::size_t(c.v) >= m_attributes.positions.size() / 3 ||
+        std::size_t(c.vt + 1) > m_attributes.texcoords.size() / 2 ||
+        std::size_t(c.vn + 1) > m_attributes.normals.size() / 3) {
+      return false;
+    }
+    // most files use each position with a single texcoord and normal, so a table lookup finds the vertex
+    unsigned& first = m_firstVertex[std::size_t(c.v - m_firstPosition)];
+
+    if (first != NO_VERTEX && m_corners[first] == c) {
+      index = first;
+      return true;
+    }
+    if (first != NO_VERTEX) {
+      auto found = m_overflow.find(c);
+
+      if (found != m_overflow.end()) {
+        index = found->second;
+        return true;
+      }
+    }
+    index = unsigned(m_corners.size());
+
+    if (first == NO_VERTEX) {
+      first = index;
+    }
+    else {
+      m_overflow.emplace(c, index);
+    }
+    m_corners.push_back(c);
+    append(m_mesh.positions, m_attributes.positions, c.v, 3);
+
+    if (c.vn >= 0) {
+      append(m_mesh.normals, m_attributes.normals, c.vn, 3);
+    }
+    if (c.vt >= 0) {
+      append(m_mesh.texcoords, m_attributes.texcoords, c.vt, 2);
+    }
+    return true;
+  }
+
+private:
+  static void append(std::vector<float>& target, std::vector<float> const& source, int index, std::size_t components) {
+    auto begin = source.begin() + std::ptrdiff_t(std::size_t(index) * components);
+    target.insert(target.end(), begin, begin + std::ptrdiff_t(components));
+  }
+
+  attributes const& m_attributes;
+  // lowest position index of the shape, the table starts there
+  int m_firstPosition;
+  // first vertex created for each position
+  std::vector<unsigned> m_firstVertex;
+  // indices each vertex was created from
+  std::vector<corner> m_corners;
+  // vertices sharing the position of an earlier vertex
+  std::unordered_map<corner, unsigned, corner_hash> m_overflow;
+  tinyobj::mesh_t& m_mesh;
+};
+
+// create the vertices and triangles of one shape, false if a face references a missing attribute
+static bool build_shape(shape_faces const& faces, std::vector<chunk> const& chunks, attributes const& attribs, tinyobj::shape_t& shape) {
+  shape.name = faces.name;
+  // the position table only needs to span the positions used by the shape
+  int first_position = 0;
+  int last_position = -1;
+  std::size_t triangle_count = 0;
+
+  for (face_range const& range : faces.ranges) {
+    chunk const& part = chunks[range.chunk];
+    std::size_t corner_end = range.face_end < part.face_starts.size() ? part.face_starts[range.face_end] : part.corners.size();
+
+    for (std::size_t i = part.face_starts[range.face_begin]; i < corner_end; ++i) {
+      int v = part.corners[i].v;
+      first_position = last_position < first_position ? v : std::min(first_position, v);
+      last_position = std::max(last_position, v);
+    }
+    triangle_count += corner_end - part.face_starts[range.face_begin];
+  }
+  if (first_position < 0 || std::size_t(last_position) >= attribs.positions.size() / 3) {
+    return false;
+  }
+  shape.mesh.indices.reserve(triangle_count * 3);
+  VertexWelder welder{attribs, first_position, last_position, shape.mesh};
+
+  for (face_range const& range : faces.ranges) {
+    chunk const& part = chunks[range.chunk];
+
+    for (std::size_t face = range.face_begin; face < range.face_end; ++face) {
+      std::size_t begin = part.face_starts[face];
+      std::size_t end = face + 1 < part.face_starts.size() ? part.face_starts[face + 1] : part.corners.size();
+      unsigned first = 0;
+      unsigned previous = 0;
+
+      // polygons are converted into triangle fans
+      for (std::size_t i = begin; i < end; ++i) {
+        unsigned index = 0;
+
+        if (!welder.add(part.corners[i], index)) {
+          return false;
+        }
+        if (i - begin >= 2) {
+          shape.mesh.indices.push_back(first);
+          shape.mesh.indices.push_back(previous);
+          shape.mesh.indices.push_back(index);
+          shape.mesh.material_ids.push_back(-1);
+        }
+        first = i == begin ? index : first;
+        previous = index;
+      }
+    }
+  }
+  return true;
+}
+
+namespace obj_parser {
+
+std::vector<tinyobj::shape_t> parse(char const* data, std::size_t size) {
+  TaskScheduler& scheduler = TaskScheduler::get();
+  std::size_t thread_count = scheduler.getWorkerCount() + 1;
+  std::size_t chunk_count = std::max(std::min(size / MIN_CHUNK_BYTES, thread_count * CHUNKS_PER_THREAD), std::size_t(1));
+  std::vector<chunk> chunks = split(data, size, chunk_count);
+
+  scheduler.parallelFor(chunks.size(), 1, [&chunks](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      parse_chunk(chunks[i]);
+    }
+  });
+
+  // attribute lists of the chunks follow each other
+  attributes attribs{};
+  for (chunk& part : chunks) {
+    // relative indices of a chunk count back from the attributes of all preceding chunks
+    for (relative_corner const& relative : part.relatives) {
+      corner& c = part.corners[relative.corner];
+      c.v += relative.components & RELATIVE_V ? int(attribs.positions.size() / 3) : 0;
+      c.vt += relative.components & RELATIVE_VT ? int(attribs.texcoords.size() / 2) : 0;
+      c.vn += relative.components & RELATIVE_VN ? int(attribs.normals.size() / 3) : 0;
+    }
+    attribs.positions.insert(attribs.positions.end(), part.positions.begin(), part.positions.end());
+    attribs.normals.insert(attribs.normals.end(), part.normals.begin(), part.normals.end());
+    attribs.texcoords.insert(attribs.texcoords.end(), part.texcoords.begin(), part.texcoords.end());
+    // free the memory early, large files hold a lot of it
+    std::vector<float>().swap(part.positions);
+    std::vector<float>().swap(part.normals);
+    std::vector<float>().swap(part.texcoords);
+  }
+
+  std::vector<shape_faces> faces = collect_shapes(chunks);
+  std::vector<tinyobj::shape_t> shapes(faces.size());
+  // exceptions can not leave the tasks, so failures are collected
+  std::vector<char> is_valid(faces.size(), 0);
+
+  scheduler.parallelFor(faces.size(), 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      is_valid[i] = build_shape(faces[i], chunks, attribs, shapes[i]) ? 1 : 0;
+    }
+  });
+  for (std::size_t i = 0; i < faces.size(); ++i) {
+    if (!is_valid[i]) {
+      throw std::logic_error("obj_parser: face of shape '" + faces[i].name + "' references a missing vertex attribute");
+    }
+  }
+  return shapes;
+}
+
+std::vector<tinyobj::shape_t> load(std::string const& path) {
+  MappedFile file{path};
+  return parse(file.getData(), file.getSize());
+}
+
+}
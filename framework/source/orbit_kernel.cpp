@@ -0,0 +1,194 @@
+#include "orbit_kernel.hpp"
+
+#include <cmath>
+
+#if defined(__AVX__)
+  #include <immintrin.h>
+  #define ORBIT_KERNEL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define ORBIT_KERNEL_SSE2
+#endif
+
+static const double TWO_PI_D = 6.283185307179586;
+static const float PI = 3.14159265f;
+static const float TWO_PI = 6.28318531f;
+static const float HALF_PI = 1.57079633f;
+
+std::size_t OrbitBatch::add(Planet const& planet) {
+  radius.push_back(planet.orbitRadius);
+  period.push_back(planet.orbitPeriod);
+  phase.push_back(planet.orbitPhase);
+  eccentricity.push_back(planet.eccentricity);
+  return radius.size() - 1;
+}
+
+void OrbitBatch::removeSwap(std::size_t index) {
+  radius[index] = radius.back();
+  period[index] = period.back();
+  phase[index] = phase.back();
+  eccentricity[index] = eccentricity.back();
+  radius.pop_back();
+  period.pop_back();
+  phase.pop_back();
+  eccentricity.pop_back();
+}
+
+void OrbitBatch::clear() {
+  radius.clear();
+  period.clear();
+  phase.clear();
+  eccentricity.clear();
+}
+
+std::size_t OrbitBatch::size() const {
+  return radius.size();
+}
+
+namespace {
+///////////////////////////// lane types //////////////////////////////////////
+// each type wraps one register of floats with the same set of operations, so the kernel is written once
+
+struct ScalarLanes {
+  static const std::size_t WIDTH = 1;
+  float v;
+};
+inline ScalarLanes broadcast(ScalarLanes, float f) { return ScalarLanes{f}; }
+inline ScalarLanes load(ScalarLanes, float const* p) { return ScalarLanes{*p}; }
+inline void store(float* p, ScalarLanes a) { *p = a.v; }
+inline ScalarLanes operator+(ScalarLanes a, ScalarLanes b) { return ScalarLanes{a.v + b.v}; }
+inline ScalarLanes operator-(ScalarLanes a, ScalarLanes b) { return ScalarLanes{a.v - b.v}; }
+inline ScalarLanes operator*(ScalarLanes a, ScalarLanes b) { return ScalarLanes{a.v * b.v}; }
+inline ScalarLanes operator/(ScalarLanes a, ScalarLanes b) { return ScalarLanes{a.v / b.v}; }
+inline ScalarLanes min(ScalarLanes a, ScalarLanes b) { return ScalarLanes{a.v < b.v ? a.v : b.v}; }
+inline ScalarLanes max(ScalarLanes a, ScalarLanes b) { return ScalarLanes{a.v > b.v ? a.v : b.v}; }
+inline ScalarLanes sqrt(ScalarLanes a) { return ScalarLanes{std::sqrt(a.v)}; }
+inline ScalarLanes round(ScalarLanes a) { return ScalarLanes{std::floor(a.v + .5f)}; }
+
+#if defined(ORBIT_KERNEL_AVX)
+struct WideLanes {
+  static const std::size_t WIDTH = 8;
+  __m256 v;
+};
+inline WideLanes broadcast(WideLanes, float f) { return WideLanes{_mm256_set1_ps(f)}; }
+inline WideLanes load(WideLanes, float const* p) { return WideLanes{_mm256_loadu_ps(p)}; }
+inline void store(float* p, WideLanes a) { _mm256_storeu_ps(p, a.v); }
+inline WideLanes operator+(WideLanes a, WideLanes b) { return WideLanes{_mm256_add_ps(a.v, b.v)}; }
+inline WideLanes operator-(WideLanes a, WideLanes b) { return WideLanes{_mm256_sub_ps(a.v, b.v)}; }
+inline WideLanes operator*(WideLanes a, WideLanes b) { return WideLanes{_mm256_mul_ps(a.v, b.v)}; }
+inline WideLanes operator/(WideLanes a, WideLanes b) { return WideLanes{_mm256_div_ps(a.v, b.v)}; }
+inline WideLanes min(WideLanes a, WideLanes b) { return WideLanes{_mm256_min_ps(a.v, b.v)}; }
+inline WideLanes max(WideLanes a, WideLanes b) { return WideLanes{_mm256_max_ps(a.v, b.v)}; }
+inline WideLanes sqrt(WideLanes a) { return WideLanes{_mm256_sqrt_ps(a.v)}; }
+inline WideLanes round(WideLanes a) { return WideLanes{_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+#elif defined(ORBIT_KERNEL_SSE2)
+struct WideLanes {
+  static const std::size_t WIDTH = 4;
+  __m128 v;
+};
+inline WideLanes broadcast(WideLanes, float f) { return WideLanes{_mm_set1_ps(f)}; }
+inline WideLanes load(WideLanes, float const* p) { return WideLanes{_mm_loadu_ps(p)}; }
+inline void store(float* p, WideLanes a) { _mm_storeu_ps(p, a.v); }
+inline WideLanes operator+(WideLanes a, WideLanes b) { return WideLanes{_mm_add_ps(a.v, b.v)}; }
+inline WideLanes operator-(WideLanes a, WideLanes b) { return WideLanes{_mm_sub_ps(a.v, b.v)}; }
+inline WideLanes operator*(WideLanes a, WideLanes b) { return WideLanes{_mm_mul_ps(a.v, b.v)}; }
+inline WideLanes operator/(WideLanes a, WideLanes b) { return WideLanes{_mm_div_ps(a.v, b.v)}; }
+inline WideLanes min(WideLanes a, WideLanes b) { return WideLanes{_mm_min_ps(a.v, b.v)}; }
+inline WideLanes max(WideLanes a, WideLanes b) { return WideLanes{_mm_max_ps(a.v, b.v)}; }
+inline WideLanes sqrt(WideLanes a) { return WideLanes{_mm_sqrt_ps(a.v)}; }
+// sse2 has no rounding instruction, but conversion to int rounds to nearest
+inline WideLanes round(WideLanes a) { return WideLanes{_mm_cvtepi32_ps(_mm_cvtps_epi32(a.v))}; }
+#else
+typedef ScalarLanes WideLanes;
+#endif
+
+///////////////////////////// kernel //////////////////////////////////////////
+// sine of any moderately sized angle
+template<typename Lanes>
+inline Lanes lanes_sin(Lanes x) {
+  Lanes pi = broadcast(x, PI);
+  // reduce to [-pi, pi]
+  x = x - broadcast(x, TWO_PI) * round(x * broadcast(x, 1.f / TWO_PI));
+  // mirror onto [-pi/2, pi/2] where the series is accurate, sin(x) = sin(pi - x)
+  x = min(x, pi - x);
+  x = max(x, broadcast(x, -PI) - x);
+  // taylor series up to x^11, error below 1e-7
+  Lanes x2 = x * x;
+  Lanes p = broadcast(x, -2.50521084e-8f);
+  p = p * x2 + broadcast(x, 2.75573192e-6f);
+  p = p * x2 + broadcast(x, -1.98412698e-4f);
+  p = p * x2 + broadcast(x, 8.33333333e-3f);
+  p = p * x2 + broadcast(x, -1.66666667e-1f);
+  return x + x * x2 * p;
+}
+
+template<typename Lanes>
+inline Lanes lanes_cos(Lanes x) {
+  return lanes_sin(x + broadcast(x, HALF_PI));
+}
+
+// single values are faster and more accurate with the standard library
+template<>
+inline ScalarLanes lanes_sin(ScalarLanes x) {
+  return ScalarLanes{std::sin(x.v)};
+}
+
+template<>
+inline ScalarLanes lanes_cos(ScalarLanes x) {
+  return ScalarLanes{std::cos(x.v)};
+}
+
+// evaluate Lanes::WIDTH bodies starting at index i
+template<typename Lanes>
+inline void evaluate_lanes(OrbitBatch const& orbits, double time, std::size_t i, float* x, float* z) {
+  Lanes tmp{};
+  float meanAnomalies[Lanes::WIDTH];
+
+  // wrap the passed orbits in double precision, so large times do not lose accuracy
+  for (std::size_t lane = 0; lane < Lanes::WIDTH; ++lane) {
+    double cycles = time / double(orbits.period[i + lane]) + double(orbits.phase[i + lane]) / TWO_PI_D;
+    meanAnomalies[lane] = float((cycles - std::floor(cycles)) * TWO_PI_D);
+  }
+  Lanes meanAnomaly = load(tmp, meanAnomalies);
+  Lanes eccentricity = load(tmp, &orbits.eccentricity[i]);
+  Lanes radius = load(tmp, &orbits.radius[i]);
+  Lanes one = broadcast(tmp, 1.f);
+
+  // solve kepler's equation M = E - e * sin(E) for the eccentric anomaly
+  Lanes anomaly = meanAnomaly + eccentricity * lanes_sin(meanAnomaly);
+
+  for (int iteration = 0; iteration < KEPLER_ITERATIONS; ++iteration) {
+    Lanes error = anomaly - eccentricity * lanes_sin(anomaly) - meanAnomaly;
+    anomaly = anomaly - error / (one - eccentricity * lanes_cos(anomaly));
+  }
+  Lanes minorScale = sqrt(one - eccentricity * eccentricity);
+  store(x, radius * (lanes_cos(anomaly) - eccentricity));
+  store(z, broadcast(tmp, 0.f) - radius * minorScale * lanes_sin(anomaly));
+}
+}
+
+namespace orbit_kernel {
+
+void evaluate(OrbitBatch const& orbits, double time, std::size_t begin, std::size_t end, float* x, float* z) {
+  std::size_t i = begin;
+
+  for (; i + WideLanes::WIDTH <= end; i += WideLanes::WIDTH) {
+    evaluate_lanes<WideLanes>(orbits, time, i, x + (i - begin), z + (i - begin));
+  }
+  // remaining bodies that do not fill a register
+  for (; i < end; ++i) {
+    evaluate_lanes<ScalarLanes>(orbits, time, i, x + (i - begin), z + (i - begin));
+  }
+}
+
+char const* instruction_set() {
+#if defined(ORBIT_KERNEL_AVX)
+  return "AVX";
+#elif defined(ORBIT_KERNEL_SSE2)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+
+}
@@ -0,0 +1,37 @@
+#include "planet.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+
+// angle that has passed after the given time with the given period, wrapped in double precision
+static float periodic_angle(double time, float period) {
+  return float(std::fmod(time, double(period)) / double(period)) * 2.f * glm::pi<float>();
+}
+
+glm::fvec3 Planet::orbitPosition(double time) const {
+  // mean anomaly grows uniformly over time
+  float meanAnomaly = orbitPhase + periodic_angle(time, orbitPeriod);
+  // solve kepler's equation M = E - e * sin(E) for the eccentric anomaly
+  float anomaly = meanAnomaly + eccentricity * std::sin(meanAnomaly);
+
+  for (int i = 0; i < KEPLER_ITERATIONS; ++i) {
+    anomaly -= (anomaly - eccentricity * std::sin(anomaly) - meanAnomaly) / (1.f - eccentricity * std::cos(anomaly));
+  }
+  // orbited body lies in a focus of the ellipse
+  float minorScale = std::sqrt(1.f - eccentricity * eccentricity);
+  // orbit in the same direction as a positive rotation around the y axis
+  return glm::fvec3(orbitRadius * (std::cos(anomaly) - eccentricity), 0, -orbitRadius * minorScale * std::sin(anomaly));
+}
+
+float Planet::rotationAngle(double time) const {
+  return periodic_angle(time, rotationPeriod);
+}
+
+glm::fmat4 Planet::orbitEllipse() const {
+  float minorScale = std::sqrt(1.f - eccentricity * eccentricity);
+  // move center of the ellipse away from the focus
+  glm::fmat4 transform = glm::translate(glm::fmat4(1), glm::fvec3(-orbitRadius * eccentricity, 0, 0));
+  return glm::scale(transform, glm::fvec3(orbitRadius, orbitRadius, orbitRadius * minorScale));
+}
@@ -0,0 +1,160 @@
+#include "procedural_mesh.hpp"
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+static const double PI = 3.14159265358979323846;
+
+// largest distance of the facets from the unit sphere, sum of the sagittas along the meridians and around the axis
+static double sphere_facet_error(std::size_t rings, std::size_t segments) {
+  return (1.0 - std::cos(PI / double(2 * rings))) + (1.0 - std::cos(PI / double(segments)));
+}
+
+// append one tessellation of the sphere, its indices address the vertices after the ones already in data
+static void append_sphere(std::size_t rings, std::size_t segments, model::attrib_flag_t attribs,
+                          std::vector<GLfloat>& data, std::vector<GLuint>& indices, std::size_t first_vertex) {
+  for (std::size_t ring = 0; ring <= rings; ++ring) {
+    double theta = PI * double(ring) / double(rings);
+    float sin_theta = float(std::sin(theta));
+    float cos_theta = float(std::cos(theta));
+
+    for (std::size_t segment = 0; segment <= segments; ++segment) {
+      // longitude grows towards +x seen from +z, so textures are not mirrored from outside
+      double phi = 2.0 * PI * double(segment) / double(segments);
+      float sin_phi = float(std::sin(phi));
+      float cos_phi = float(std::cos(phi));
+      // on the unit sphere the normal is the position
+      float x = sin_theta * sin_phi;
+      float y = cos_theta;
+      float z = sin_theta * cos_phi;
+
+      data.insert(data.end(), {x, y, z});
+      if (attribs & model::NORMAL) {
+        data.insert(data.end(), {x, y, z});
+      }
+      if (attribs & model::TEXCOORD) {
+        data.insert(data.end(), {float(segment) / float(segments), 1.0f - float(ring) / float(rings)});
+      }
+      // derivatives along u and v, also defined at the poles
+      if (attribs & model::TANGENT) {
+        data.insert(data.end(), {cos_phi, 0.0f, -sin_phi});
+      }
+      if (attribs & model::BITANGENT) {
+        data.insert(data.end(), {-cos_theta * sin_phi, sin_theta, -cos_theta * cos_phi});
+      }
+    }
+  }
+
+  for (std::size_t ring = 0; ring < rings; ++ring) {
+    for (std::size_t segment = 0; segment < segments; ++segment) {
+      GLuint a = GLuint(first_vertex + ring * (segments + 1) + segment);
+      GLuint b = a + GLuint(segments + 1);
+      // the upper triangle collapses at the north pole and the lower one at the south pole
+      if (ring > 0) {
+        indices.insert(indices.end(), {a, b, a + 1});
+      }
+      if (ring + 1 < rings) {
+        indices.insert(indices.end(), {a + 1, b, b + 1});
+      }
+    }
+  }
+}
+
+namespace procedural_mesh {
+
+model sphere(std::size_t rings, std::size_t segments, model::attrib_flag_t attribs, std::size_t lod_count) {
+  if (rings < 2 || segments < 3) {
+    throw std::logic_error("A sphere needs at least 2 rings and 3 segments");
+  }
+  attribs |= model::POSITION;
+  std::vector<GLfloat> data;
+  std::vector<GLuint> indices;
+  std::vector<model::lod> lods;
+  double full_error = sphere_facet_error(rings, segments);
+  std::map<model::attrib_flag_t, GLvoid*> offsets;
+  std::size_t vertex_floats = std::size_t(model::compute_offsets(attribs, offsets)) / sizeof(GLfloat);
+  std::size_t vertices = 0;
+
+  for (std::size_t level = 0; level < lod_count; ++level) {
+    std::size_t level_rings = rings >> level;
+    std::size_t level_segments = segments >> level;
+    // the full mesh is always built, coarser levels stop at the minimum tessellation
+    if (level > 0 && (level_rings < MIN_SPHERE_RINGS || level_segments < 2 * MIN_SPHERE_RINGS)) {
+      break;
+    }
+    data.reserve(data.size() + sphere_vertex_count(level_rings, level_segments) * vertex_floats);
+    std::size_t first_index = indices.size();
+    append_sphere(level_rings, level_segments, attribs, data, indices, vertices);
+    vertices += sphere_vertex_count(level_rings, level_segments);
+    lods.push_back(model::lod{first_index, indices.size() - first_index,
+                              float(sphere_facet_error(level_rings, level_segments) - full_error)});
+  }
+
+  model mdl{data, attribs, indices};
+  // a single level is the plain mesh
+  if (lods.size() > 1) {
+    mdl.lods = lods;
+  }
+  return mdl;
+}
+
+model ring(std::size_t segments, float inner_radius, float outer_radius) {
+  std::vector<GLfloat> data;
+  std::vector<GLuint> indices;
+  data.reserve(ring_vertex_count(segments) * 8);
+  indices.reserve(ring_index_count(segments));
+
+  for (std::size_t segment = 0; segment <= segments; ++segment) {
+    double phi = 2.0 * PI * double(segment) / double(segments);
+    float cos_phi = float(std::cos(phi));
+    float sin_phi = float(std::sin(phi));
+    float v = float(segment) / float(segments);
+
+    data.insert(data.end(), {cos_phi * inner_radius, 0.0f, sin_phi * inner_radius, 0.0f, 1.0f, 0.0f, 0.0f, v});
+    data.insert(data.end(), {cos_phi * outer_radius, 0.0f, sin_phi * outer_radius, 0.0f, 1.0f, 0.0f, 1.0f, v});
+    indices.insert(indices.end(), {GLuint(2 * segment), GLuint(2 * segment + 1)});
+  }
+  return model{data, model::POSITION | model::NORMAL | model::TEXCOORD, indices};
+}
+
+model orbit(std::size_t segments) {
+  std::vector<GLfloat> data;
+  std::vector<GLuint> indices;
+  data.reserve(orbit_vertex_count(segments) * 3);
+  indices.reserve(orbit_index_count(segments));
+
+  for (std::size_t segment = 0; segment < segments; ++segment) {
+    double phi = 2.0 * PI * double(segment) / double(segments);
+    data.insert(data.end(), {float(std::cos(phi)), 0.0f, float(std::sin(phi))});
+    indices.push_back(GLuint(segment));
+  }
+  return model{data, model::POSITION, indices};
+}
+
+model cube() {
+  std::vector<GLfloat> data{
+    //-Z back face
+    -1.0f,  1.0f, -1.0f,
+     1.0f,  1.0f, -1.0f,
+    -1.0f, -1.0f, -1.0f,
+     1.0f, -1.0f, -1.0f,
+    //+Z front face
+    -1.0f,  1.0f,  1.0f,
+     1.0f,  1.0f,  1.0f,
+    -1.0f, -1.0f,  1.0f,
+     1.0f, -1.0f,  1.0f,
+  };
+  std::vector<GLuint> indices{
+    1, 5, 3, 3, 5, 7, // +X
+    4, 0, 6, 6, 0, 2, // -X
+    4, 5, 0, 0, 5, 1, // +Y
+    6, 7, 2, 2, 7, 3, // -Y
+    5, 4, 7, 7, 4, 6, // +Z
+    0, 1, 2, 2, 1, 3, // -Z
+  };
+  return model{data, model::POSITION, indices};
+}
+
+}
@@ -0,0 +1,96 @@
+#include "render_queue.hpp"
+#include "node.hpp"
+
+#include <algorithm>
+
+// depth beyond which items are no longer ordered front to back
+static const float MAX_SORT_DEPTH = 1000.f;
+// each part of the key keeps the lowest 16 bits of its value
+static const std::uint64_t KEY_MASK = 0xffff;
+
+// handles only decide the grouping, so truncated handles at worst split a group
+static std::uint64_t make_key(GLuint program, GLuint texture, GLuint vertexArray, float depth) {
+  float clamped = std::min(std::max(depth, 0.f), MAX_SORT_DEPTH);
+  // front to back inside a group, so the depth test rejects hidden fragments early
+  std::uint64_t quantized = std::uint64_t(clamped / MAX_SORT_DEPTH * float(KEY_MASK));
+
+  return (std::uint64_t(program) & KEY_MASK) << 48 |
+         (std::uint64_t(texture) & KEY_MASK) << 32 |
+         (std::uint64_t(vertexArray) & KEY_MASK) << 16 |
+         quantized;
+}
+
+RenderQueue::RenderQueue() :
+    m_items{},
+    m_stats{},
+    m_lodScale{0.f} {}
+
+void RenderQueue::clear() {
+  m_items.clear();
+  m_stats = RenderStats{};
+}
+
+void RenderQueue::add(Node& node, shader_program const& shader, GLuint vertexArray, texture_object const& texture, float depth) {
+  m_items.push_back(RenderItem{make_key(shader.handle, texture.handle, vertexArray, depth), &node, &shader, vertexArray, texture});
+}
+
+void RenderQueue::submit() {
+  std::sort(m_items.begin(), m_items.end(), [](RenderItem const& a, RenderItem const& b) {
+    return a.key < b.key;
+  });
+  // state of the context is unknown before the first item
+  GLuint boundProgram = 0;
+  GLuint boundVertexArray = 0;
+  texture_object boundTexture{};
+  bool isFirst = true;
+
+  for (RenderItem const& item : m_items) {
+    if (isFirst || item.shader->handle != boundProgram) {
+      glUseProgram(item.shader->handle);
+      boundProgram = item.shader->handle;
+      ++m_stats.programBinds;
+    } else {
+      ++m_stats.programBindsAvoided;
+    }
+
+    if (isFirst || item.vertexArray != boundVertexArray) {
+      glBindVertexArray(item.vertexArray);
+      boundVertexArray = item.vertexArray;
+      ++m_stats.vertexArrayBinds;
+    } else {
+      ++m_stats.vertexArrayBindsAvoided;
+    }
+
+    // items without texture leave the bound one untouched
+    if (item.texture.handle != 0) {
+      if (item.texture.handle != boundTexture.handle || item.texture.target != boundTexture.target) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(item.texture.target, item.texture.handle);
+        boundTexture = item.texture;
+        ++m_stats.textureBinds;
+      } else {
+        ++m_stats.textureBindsAvoided;
+      }
+    }
+    isFirst = false;
+
+    item.node->draw(*item.shader);
+    ++m_stats.drawCalls;
+  }
+}
+
+std::size_t RenderQueue::size() const {
+  return m_items.size();
+}
+
+RenderStats const& RenderQueue::getStats() const {
+  return m_stats;
+}
+
+void RenderQueue::setLodScale(float pixelsPerUnit) {
+  m_lodScale = pixelsPerUnit;
+}
+
+float RenderQueue::getLodScale() const {
+  return m_lodScale;
+}
@@ -0,0 +1,57 @@
+#include "scene_graph.hpp"
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// nodes with more children than this split them into parallel tasks
+static const std::size_t SPLIT_CHILD_COUNT = 256;
+
+static void resolve_children(std::shared_ptr<Node> const& node);
+
+// resolve world transforms of a node and its children top down
+static void resolve_subtree(std::shared_ptr<Node> const& node) {
+  // parent is already resolved, so this never walks up into other subtrees
+  node->getWorldTransform();
+
+  if (node->getChildrenList().size() > SPLIT_CHILD_COUNT) {
+    resolve_children(node);
+    return;
+  }
+  for (auto const& pair : node->getChildrenList()) {
+    resolve_subtree(pair.second);
+  }
+}
+
+// resolve the subtrees of all children of a resolved node in parallel
+static void resolve_children(std::shared_ptr<Node> const& node) {
+  std::vector<std::shared_ptr<Node>> children{};
+  children.reserve(node->getChildrenList().size());
+
+  for (auto const& pair : node->getChildrenList()) {
+    children.push_back(pair.second);
+  }
+  TaskScheduler& scheduler = TaskScheduler::get();
+  // a few batches per thread, so stealing can balance subtrees of different size
+  std::size_t batchSize = std::max(children.size() / ((scheduler.getWorkerCount() + 1) * 4), std::size_t(1));
+
+  // large child lists further down are split again from inside the tasks
+  scheduler.parallelFor(children.size(), batchSize, [&children](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      resolve_subtree(children[i]);
+    }
+  });
+}
+
+void SceneGraph::update(double dTime) {
+  m_animations.update(dTime);
+
+  if (m_isStoreEnabled) {
+    // store resolves everything in one linear pass
+    m_transforms.update();
+    return;
+  }
+  // resolve the root first, so tasks only read it
+  m_root->getWorldTransform();
+  resolve_children(m_root);
+}
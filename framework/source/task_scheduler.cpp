@@ -0,0 +1,206 @@
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+TaskScheduler::TaskScheduler(unsigned workerCount) :
+    m_queues{},
+    m_workers{},
+    m_nextQueue{0},
+    m_queuedTasks{0},
+    m_pendingTasks{0},
+    m_isStopping{false} {
+  // last queue is used by threads outside the pool
+  for (unsigned i = 0; i <= workerCount; ++i) {
+    m_queues.emplace_back(new WorkQueue{});
+  }
+  for (unsigned i = 0; i < workerCount; ++i) {
+    m_workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock{m_sleepMutex};
+    m_isStopping = true;
+  }
+  m_taskQueued.notify_all();
+
+  for (std::thread& worker : m_workers) {
+    worker.join();
+  }
+}
+
+TaskScheduler& TaskScheduler::get() {
+  // instantiates a static member on first call
+  static TaskScheduler instance{std::max(std::thread::hardware_concurrency(), 1u) - 1};
+  return instance;
+}
+
+unsigned TaskScheduler::getWorkerCount() const {
+  return unsigned(m_workers.size());
+}
+
+void TaskScheduler::submit(std::function<void()> task) {
+  enqueue(Task{std::move(task), nullptr}, false);
+}
+
+void TaskScheduler::submitBackground(std::function<void()> task) {
+  enqueue(Task{std::move(task), nullptr}, true);
+}
+
+void TaskScheduler::enqueue(Task task, bool isBackground) {
+  // workers keep their subtasks local, other threads distribute them evenly
+  unsigned queueIndex = getQueueIndex();
+
+  if (queueIndex == m_workers.size()) {
+    bool isWorkerOnly = isBackground && !m_workers.empty();
+    queueIndex = m_nextQueue++ % unsigned(isWorkerOnly ? m_workers.size() : m_queues.size());
+  }
+  ++m_pendingTasks;
+  {
+    std::lock_guard<std::mutex> lock{m_queues[queueIndex]->mutex};
+    m_queues[queueIndex]->tasks.push_back(std::move(task));
+  }
+  {
+    // counter is changed while locked so no sleeping worker misses it
+    std::lock_guard<std::mutex> lock{m_sleepMutex};
+    ++m_queuedTasks;
+  }
+  m_taskQueued.notify_one();
+}
+
+void TaskScheduler::wait() {
+  unsigned queueIndex = unsigned(m_queues.size()) - 1;
+  std::function<void()> task;
+
+  while (m_pendingTasks > 0) {
+    if (takeTask(queueIndex, task)) {
+      runTask(task);
+      continue;
+    }
+    // remaining tasks are running on workers
+    std::unique_lock<std::mutex> lock{m_sleepMutex};
+    m_tasksDone.wait(lock, [this]() {
+      return m_pendingTasks == 0 || m_queuedTasks > 0;
+    });
+  }
+}
+
+void TaskScheduler::parallelFor(std::size_t count, std::size_t batchSize, std::function<void(std::size_t, std::size_t)> const& func) {
+  batchSize = std::max(batchSize, std::size_t(1));
+
+  // not worth scheduling a single batch
+  if (count <= batchSize) {
+    func(0, count);
+    return;
+  }
+  // count own batches, so this also works when called from inside a task
+  std::size_t batchCount = (count + batchSize - 1) / batchSize;
+  BatchGroup group{};
+  group.queued = batchCount;
+  group.remaining = batchCount;
+
+  for (std::size_t begin = 0; begin < count; begin += batchSize) {
+    std::size_t end = std::min(begin + batchSize, count);
+    enqueue(Task{[this, &func, &group, begin, end]() {
+      func(begin, end);
+
+      if (--group.remaining == 0) {
+        // notify while locked, the waiting thread may otherwise return and destroy the counter in between
+        std::lock_guard<std::mutex> lock{m_sleepMutex};
+        m_tasksDone.notify_all();
+      }
+    }, &group}, false);
+  }
+  unsigned queueIndex = getQueueIndex();
+  std::function<void()> task;
+
+  // help processing the own batches instead of blocking
+  while (group.queued > 0 && takeTask(queueIndex, task, &group)) {
+    runTask(task);
+  }
+  // remaining batches are running on other threads
+  std::unique_lock<std::mutex> lock{m_sleepMutex};
+  m_tasksDone.wait(lock, [&group]() {
+    return group.remaining == 0;
+  });
+}
+
+unsigned TaskScheduler::getQueueIndex() const {
+  std::thread::id id = std::this_thread::get_id();
+
+  for (std::size_t i = 0; i < m_workers.size(); ++i) {
+    if (m_workers[i].get_id() == id) {
+      return unsigned(i);
+    }
+  }
+  // last queue belongs to threads outside the pool
+  return unsigned(m_workers.size());
+}
+
+void TaskScheduler::workerLoop(unsigned index) {
+  std::function<void()> task;
+
+  while (true) {
+    if (takeTask(index, task)) {
+      runTask(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock{m_sleepMutex};
+    m_taskQueued.wait(lock, [this]() {
+      return m_isStopping || m_queuedTasks > 0;
+    });
+    if (m_isStopping && m_queuedTasks == 0) {
+      return;
+    }
+  }
+}
+
+bool TaskScheduler::takeTask(unsigned queueIndex, std::function<void()>& task, BatchGroup* group) {
+  auto isTakeable = [group](Task const& queued) {
+    return group == nullptr || queued.group == group;
+  };
+  // move the task out of its queue, called while the queue is locked
+  auto pop = [this, &task](WorkQueue& queue, std::deque<Task>::iterator position) {
+    task = std::move(position->func);
+    if (position->group != nullptr) {
+      --position->group->queued;
+    }
+    queue.tasks.erase(position);
+    --m_queuedTasks;
+  };
+  {
+    // newest own task is most likely to still be in cache
+    WorkQueue& queue = *m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    auto newest = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), isTakeable);
+
+    if (newest != queue.tasks.rend()) {
+      pop(queue, std::next(newest).base());
+      return true;
+    }
+  }
+  // steal the oldest task from the other queues, which usually is the biggest chunk of work
+  for (std::size_t i = 1; i < m_queues.size(); ++i) {
+    WorkQueue& queue = *m_queues[(queueIndex + i) % m_queues.size()];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    auto oldest = std::find_if(queue.tasks.begin(), queue.tasks.end(), isTakeable);
+
+    if (oldest != queue.tasks.end()) {
+      pop(queue, oldest);
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::runTask(std::function<void()>& task) {
+  task();
+  task = nullptr;
+
+  if (--m_pendingTasks == 0) {
+    std::lock_guard<std::mutex> lock{m_sleepMutex};
+    m_tasksDone.notify_all();
+  }
+}
@@ -0,0 +1,408 @@
+#include "texture_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+// increase when the layout of the file changes, older files are ignored until they are baked again
+static const std::uint32_t VERSION = 1;
+static const char MAGIC[4] = {'T', 'E', 'X', 'B'};
+
+// bytes of all blocks covering a level
+static std::uint64_t level_bytes(GLenum format, std::uint64_t width, std::uint64_t height) {
+  return (width + 3) / 4 * ((height + 3) / 4) * texture_cache::block_bytes(format);
+}
+
+// check the header and that every level lies inside the file and has the size its dimensions need
+static bool is_valid(texture_cache::header const& head, char const* data, std::size_t file_size) {
+  GLenum format = GLenum(head.format);
+
+  if (std::memcmp(head.magic, MAGIC, sizeof(MAGIC)) != 0 || head.version != VERSION || head.level_count == 0 ||
+      (format != GL_COMPRESSED_RGB_S3TC_DXT1_EXT && format != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)) {
+    return false;
+  }
+  std::uint64_t table_end = sizeof(head) + std::uint64_t(head.level_count) * sizeof(texture_cache::level_range);
+  if (table_end > file_size) {
+    return false;
+  }
+  for (std::size_t i = 0; i < head.level_count; ++i) {
+    texture_cache::level_range range{};
+    std::memcpy(&range, data + sizeof(head) + i * sizeof(range), sizeof(range));
+
+    if (range.offset < table_end || range.offset + range.size > file_size ||
+        range.size != level_bytes(format, range.width, range.height)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// number of 8 bit components of the pixel format
+static std::size_t channel_count(GLenum channels) {
+  if (channels == GL_RED) {
+    return 1;
+  }
+  if (channels == GL_RG) {
+    return 2;
+  }
+  return channels == GL_RGBA ? 4 : 3;
+}
+
+// 16 pixels of the block at the given block coordinates as rgba, edge pixels repeat past the image borders
+static void read_block(pixel_data const& image, std::size_t block_x, std::size_t block_y, std::uint8_t block[16][4]) {
+  std::size_t components = channel_count(image.channels);
+  std::uint8_t const* pixels = static_cast<std::uint8_t const*>(image.ptr());
+
+  for (std::size_t y = 0; y < 4; ++y) {
+    std::size_t row = std::min(block_y * 4 + y, image.height - 1);
+    for (std::size_t x = 0; x < 4; ++x) {
+      std::size_t column = std::min(block_x * 4 + x, image.width - 1);
+      std::uint8_t const* pixel = pixels + (row * image.width + column) * components;
+      std::uint8_t* texel = block[y * 4 + x];
+
+      texel[0] = pixel[0];
+      texel[1] = pixel[std::min(std::size_t(1), components - 1)];
+      texel[2] = pixel[std::min(std::size_t(2), components - 1)];
+      texel[3] = components == 4 ? pixel[3] : 255;
+    }
+  }
+}
+
+// rgb565 color and its expansion back to 8 bit per channel
+static std::uint16_t pack_565(float const color[3]) {
+  int r = std::min(std::max(int(color[0] * 31.0f / 255.0f + 0.5f), 0), 31);
+  int g = std::min(std::max(int(color[1] * 63.0f / 255.0f + 0.5f), 0), 63);
+  int b = std::min(std::max(int(color[2] * 31.0f / 255.0f + 0.5f), 0), 31);
+  return std::uint16_t((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(std::uint16_t packed, int color[3]) {
+  int r = (packed >> 11) & 31;
+  int g = (packed >> 5) & 63;
+  int b = packed & 31;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+// bc1 color block, the endpoints are the extremes of the colors along their principal axis
+// the first endpoint is always the larger one, so the block uses four colors and no transparency
+static void encode_color_block(std::uint8_t const block[16][4], std::uint8_t* out) {
+  float mean[3] = {0.0f, 0.0f, 0.0f};
+  for (std::size_t i = 0; i < 16; ++i) {
+    for (std::size_t c = 0; c < 3; ++c) {
+      mean[c] += float(block[i][c]) / 16.0f;
+    }
+  }
+  float covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  for (std::size_t i = 0; i < 16; ++i) {
+    float r = float(block[i][0]) - mean[0];
+    float g = float(block[i][1]) - mean[1];
+    float b = float(block[i][2]) - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+  // a few power iterations find the axis of the largest spread, luminance is the fallback for flat blocks
+  float axis[3] = {0.299f, 0.587f, 0.114f};
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    float next[3] = {
+      covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+      covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+      covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+    };
+    float length = std::max(std::max(std::abs(next[0]), std::abs(next[1])), std::abs(next[2]));
+    if (length <= 0.0f) {
+      break;
+    }
+    for (std::size_t c = 0; c < 3; ++c) {
+      axis[c] = next[c] / length;
+    }
+  }
+  std::size_t min_pixel = 0;
+  std::size_t max_pixel = 0;
+  float min_projection = 0.0f;
+  float max_projection = 0.0f;
+  for (std::size_t i = 0; i < 16; ++i) {
+    float projection = float(block[i][0]) * axis[0] + float(block[i][1]) * axis[1] + float(block[i][2]) * axis[2];
+    if (i == 0 || projection < min_projection) {
+      min_projection = projection;
+      min_pixel = i;
+    }
+    if (i == 0 || projection > max_projection) {
+      max_projection = projection;
+      max_pixel = i;
+    }
+  }
+  float max_color[3] = {float(block[max_pixel][0]), float(block[max_pixel][1]), float(block[max_pixel][2])};
+  float min_color[3] = {float(block[min_pixel][0]), float(block[min_pixel][1]), float(block[min_pixel][2])};
+  std::uint16_t color0 = pack_565(max_color);
+  std::uint16_t color1 = pack_565(min_color);
+  if (color0 < color1) {
+    std::swap(color0, color1);
+  }
+  std::uint32_t indices = 0;
+
+  // equal endpoints would switch to three colors, index 0 already is the only color
+  if (color0 != color1) {
+    int palette[4][3];
+    unpack_565(color0, palette[0]);
+    unpack_565(color1, palette[1]);
+    for (std::size_t c = 0; c < 3; ++c) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    for (std::size_t i = 0; i < 16; ++i) {
+      std::uint32_t best = 0;
+      int best_distance = 0;
+      for (std::uint32_t entry = 0; entry < 4; ++entry) {
+        int distance = 0;
+        for (std::size_t c = 0; c < 3; ++c) {
+          int difference = int(block[i][c]) - palette[entry][c];
+          distance += difference * difference;
+        }
+        if (entry == 0 || distance < best_distance) {
+          best = entry;
+          best_distance = distance;
+        }
+      }
+      indices |= best << (2 * i);
+    }
+  }
+  out[0] = std::uint8_t(color0 & 0xFF);
+  out[1] = std::uint8_t(color0 >> 8);
+  out[2] = std::uint8_t(color1 & 0xFF);
+  out[3] = std::uint8_t(color1 >> 8);
+  for (std::size_t byte = 0; byte < 4; ++byte) {
+    out[4 + byte] = std::uint8_t((indices >> (8 * byte)) & 0xFF);
+  }
+}
+
+// bc3 alpha block with the extremes as endpoints and six values interpolated between them
+static void encode_alpha_block(std::uint8_t const block[16][4], std::uint8_t* out) {
+  int alpha0 = 0;
+  int alpha1 = 255;
+  for (std::size_t i = 0; i < 16; ++i) {
+    alpha0 = std::max(alpha0, int(block[i][3]));
+    alpha1 = std::min(alpha1, int(block[i][3]));
+  }
+  std::uint64_t indices = 0;
+
+  // equal endpoints select the five value mode, index 0 still is the only value
+  if (alpha0 != alpha1) {
+    int palette[8] = {alpha0, alpha1};
+    for (int i = 1; i < 7; ++i) {
+      palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+    }
+    for (std::size_t i = 0; i < 16; ++i) {
+      std::uint64_t best = 0;
+      int best_distance = 256;
+      for (std::uint64_t entry = 0; entry < 8; ++entry) {
+        int distance = std::abs(int(block[i][3]) - palette[entry]);
+        if (distance < best_distance) {
+          best = entry;
+          best_distance = distance;
+        }
+      }
+      indices |= best << (3 * i);
+    }
+  }
+  out[0] = std::uint8_t(alpha0);
+  out[1] = std::uint8_t(alpha1);
+  for (std::size_t byte = 0; byte < 6; ++byte) {
+    out[2 + byte] = std::uint8_t((indices >> (8 * byte)) & 0xFF);
+  }
+}
+
+// compress all blocks of the image with the given block encoder
+template<typename Encode>
+static std::vector<std::uint8_t> compress(pixel_data const& image, std::size_t bytes, Encode encode) {
+  std::size_t blocks_x = (image.width + 3) / 4;
+  std::size_t blocks_y = (image.height + 3) / 4;
+  std::vector<std::uint8_t> blocks(blocks_x * blocks_y * bytes);
+  std::uint8_t block[16][4];
+
+  for (std::size_t y = 0; y < blocks_y; ++y) {
+    for (std::size_t x = 0; x < blocks_x; ++x) {
+      read_block(image, x, y, block);
+      encode(block, &blocks[(y * blocks_x + x) * bytes]);
+    }
+  }
+  return blocks;
+}
+
+// throws if the image is not in a format the blocks are built from
+static void check_format(pixel_data const& image) {
+  if (image.channel_type != GL_UNSIGNED_BYTE || (image.channels != GL_RGB && image.channels != GL_RGBA) ||
+      image.width == 0 || image.height == 0) {
+    throw std::logic_error("Only 8 bit rgb and rgba images can be block compressed");
+  }
+}
+
+namespace texture_cache {
+
+std::size_t block_bytes(GLenum format) {
+  return format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+}
+
+pixel_data downsample(pixel_data const& image) {
+  std::size_t components = channel_count(image.channels);
+  std::size_t width = std::max(image.width / 2, std::size_t(1));
+  std::size_t height = std::max(image.height / 2, std::size_t(1));
+  pixel_data half{std::vector<std::uint8_t>(width * height * components), image.channels, image.channel_type, width, height};
+  std::uint8_t const* source = static_cast<std::uint8_t const*>(image.ptr());
+  std::uint8_t* target = half.pixels.get();
+
+  for (std::size_t y = 0; y < height; ++y) {
+    // odd sizes drop the last row and column, single rows and columns are averaged with themselves
+    std::size_t row0 = std::min(2 * y, image.height - 1) * image.width;
+    std::size_t row1 = std::min(2 * y + 1, image.height - 1) * image.width;
+    for (std::size_t x = 0; x < width; ++x) {
+      std::size_t column0 = std::min(2 * x, image.width - 1);
+      std::size_t column1 = std::min(2 * x + 1, image.width - 1);
+      for (std::size_t c = 0; c < components; ++c) {
+        unsigned sum = unsigned(source[(row0 + column0) * components + c]) + source[(row0 + column1) * components + c] +
+                       source[(row1 + column0) * components + c] + source[(row1 + column1) * components + c];
+        target[(y * width + x) * components + c] = std::uint8_t((sum + 2) / 4);
+      }
+    }
+  }
+  return half;
+}
+
+std::vector<std::uint8_t> compress_bc1(pixel_data const& image) {
+  check_format(image);
+  return compress(image, 8, encode_color_block);
+}
+
+std::vector<std::uint8_t> compress_bc3(pixel_data const& image) {
+  check_format(image);
+  return compress(image, 16, [](std::uint8_t const block[16][4], std::uint8_t* out) {
+    encode_alpha_block(block, out);
+    encode_color_block(block, out + 8);
+  });
+}
+
+std::string cache_path(std::string const& source_path) {
+  return source_path + ".tex";
+}
+
+std::vector<char> serialize(pixel_data const& image, std::string const& source_path) {
+  check_format(image);
+  header head{};
+  std::memcpy(head.magic, MAGIC, sizeof(MAGIC));
+  head.version = VERSION;
+  bool has_alpha = image.channels == GL_RGBA;
+  head.format = std::uint32_t(has_alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+  // stamp of the source the image was just decoded from
+  file_cache::file_stamp(source_path, head.source_size, head.source_time);
+
+  // every level is built from the previous one, down to a single pixel
+  std::vector<std::vector<std::uint8_t>> levels;
+  std::vector<level_range> ranges;
+  pixel_data const* level = &image;
+  pixel_data smaller;
+  while (true) {
+    levels.push_back(has_alpha ? compress_bc3(*level) : compress_bc1(*level));
+    ranges.push_back(level_range{std::uint32_t(level->width), std::uint32_t(level->height), 0, levels.back().size()});
+    if (level->width == 1 && level->height == 1) {
+      break;
+    }
+    smaller = downsample(*level);
+    level = &smaller;
+  }
+  head.level_count = std::uint32_t(levels.size());
+
+  std::size_t size = sizeof(head) + ranges.size() * sizeof(level_range);
+  for (level_range& range : ranges) {
+    range.offset = size;
+    size += std::size_t(range.size);
+  }
+  std::vector<char> contents(size);
+  std::memcpy(contents.data(), &head, sizeof(head));
+  std::memcpy(contents.data() + sizeof(head), ranges.data(), ranges.size() * sizeof(level_range));
+  for (std::size_t i = 0; i < levels.size(); ++i) {
+    std::memcpy(contents.data() + ranges[i].offset, levels[i].data(), levels[i].size());
+  }
+  return contents;
+}
+
+void write(std::string const& path, std::vector<char> const& contents) {
+  file_cache::write_atomic(path, contents);
+}
+
+bool is_current(std::string const& path, std::string const& source_path) {
+  std::ifstream file{path, std::ios::binary};
+
+  if (!file) {
+    return false;
+  }
+  header head{};
+  if (!file.read(reinterpret_cast<char*>(&head), sizeof(head)) ||
+      std::memcmp(head.magic, MAGIC, sizeof(MAGIC)) != 0 || head.version != VERSION) {
+    return false;
+  }
+  std::uint64_t source_size = 0;
+  std::int64_t source_time = 0;
+
+  // without the source the baked file is all there is
+  if (!file_cache::file_stamp(source_path, source_size, source_time)) {
+    return true;
+  }
+  return head.source_size == source_size && head.source_time == source_time;
+}
+
+}
+
+MappedTexture::MappedTexture(std::string const& path) :
+    m_file{path},
+    m_format{GL_NONE},
+    m_levels{} {
+  texture_cache::header head{};
+
+  if (m_file.getSize() >= sizeof(head)) {
+    std::memcpy(&head, m_file.getData(), sizeof(head));
+  }
+  if (m_file.getSize() < sizeof(head) || !is_valid(head, m_file.getData(), m_file.getSize())) {
+    throw std::logic_error("Invalid texture file " + path);
+  }
+  m_format = GLenum(head.format);
+  m_levels.resize(head.level_count);
+  std::memcpy(m_levels.data(), m_file.getData() + sizeof(head), m_levels.size() * sizeof(texture_cache::level_range));
+}
+
+MappedTexture::MappedTexture(MappedTexture&& other) :
+    m_file{std::move(other.m_file)},
+    m_format{other.m_format},
+    m_levels{std::move(other.m_levels)} {}
+
+GLenum MappedTexture::getFormat() const {
+  return m_format;
+}
+
+std::size_t MappedTexture::getLevelCount() const {
+  return m_levels.size();
+}
+
+std::size_t MappedTexture::getWidth(std::size_t level) const {
+  return m_levels[level].width;
+}
+
+std::size_t MappedTexture::getHeight(std::size_t level) const {
+  return m_levels[level].height;
+}
+
+void const* MappedTexture::getLevelData(std::size_t level) const {
+  return m_file.getData() + m_levels[level].offset;
+}
+
+std::size_t MappedTexture::getLevelSize(std::size_t level) const {
+  return std::size_t(m_levels[level].size);
+}
@@ -11,14 +11,19 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
  
+#include <algorithm>
 #include <cstdint> 
-#include <cstring> 
+#include <mutex>
 #include <stdexcept> 
+#include <utility>
 
 namespace texture_loader {
 pixel_data file(std::string const& file_name, bool flipVertically) {
-  // match to opengl representation
-  stbi_set_flip_vertically_on_load(true);
+  // match to opengl representation, the flag is global in stb_image so it is only set once for all decoding threads
+  static std::once_flag flip_set;
+  std::call_once(flip_set, []() {
+    stbi_set_flip_vertically_on_load(true);
+  });
 
   uint8_t* data_ptr;
   int width = 0;
@@ -29,36 +34,59 @@ pixel_data file(std::string const& file_name, bool flipVertically) {
   if(!data_ptr) {
     throw std::logic_error(std::string{"stb_image: "} + stbi_failure_reason());
   }
+  // the decoded buffer is handed over as is and freed by stb_image once the pixel data is destroyed
+  pixel_data::buffer_t buffer{data_ptr, stbi_image_free};
 
   // determine format of image data, internal format should be sized
   GLenum pixel_format = GL_NONE;
-  std::size_t num_components = 0;
   if (format == STBI_grey) {
     pixel_format = GL_RED;
-    num_components = 1;
   }
   else if (format == STBI_grey_alpha) {
     pixel_format = GL_RG;
-    num_components = 2;
   }
   else if (format == STBI_rgb) {
     pixel_format = GL_RGB;
-    num_components = 3;
   }
   else if (format == STBI_rgb_alpha) {
     pixel_format = GL_RGBA;
-    num_components = 4;
   }
   else {
     throw std::logic_error("stb_image: misinterpreted data, incorrect format");
   }
 
-  std::vector<uint8_t> texture_data(width * height * num_components);
-  // copy data to vector
-  std::memcpy(&texture_data[0], data_ptr, texture_data.size());
-  stbi_image_free(data_ptr);
+  return pixel_data{std::move(buffer), pixel_format, GL_UNSIGNED_BYTE, std::size_t(width), std::size_t(height)};
+}
+
+pixel_data resize(pixel_data const& image, std::size_t width, std::size_t height) {
+  std::size_t components = image.channels == GL_RED ? 1 : image.channels == GL_RG ? 2 : image.channels == GL_RGB ? 3 : 4;
+  pixel_data resized{std::vector<std::uint8_t>(width * height * components), image.channels, image.channel_type, width, height};
+  std::uint8_t const* source = static_cast<std::uint8_t const*>(image.ptr());
+  std::uint8_t* target = resized.pixels.get();
+  // ratio between the pixel centers of both images
+  float scale_x = float(image.width) / float(width);
+  float scale_y = float(image.height) / float(height);
 
-  return pixel_data{texture_data, pixel_format, GL_UNSIGNED_BYTE, std::size_t(width), std::size_t(height)};
+  for (std::size_t y = 0; y < height; ++y) {
+    float source_y = std::max((float(y) + 0.5f) * scale_y - 0.5f, 0.0f);
+    std::size_t row0 = std::min(std::size_t(source_y), image.height - 1);
+    std::size_t row1 = std::min(row0 + 1, image.height - 1);
+    float weight_y = source_y - float(row0);
+    for (std::size_t x = 0; x < width; ++x) {
+      float source_x = std::max((float(x) + 0.5f) * scale_x - 0.5f, 0.0f);
+      std::size_t column0 = std::min(std::size_t(source_x), image.width - 1);
+      std::size_t column1 = std::min(column0 + 1, image.width - 1);
+      float weight_x = source_x - float(column0);
+      for (std::size_t c = 0; c < components; ++c) {
+        float top = float(source[(row0 * image.width + column0) * components + c]) * (1.0f - weight_x) +
+                    float(source[(row0 * image.width + column1) * components + c]) * weight_x;
+        float bottom = float(source[(row1 * image.width + column0) * components + c]) * (1.0f - weight_x) +
+                       float(source[(row1 * image.width + column1) * components + c]) * weight_x;
+        target[(y * width + x) * components + c] = std::uint8_t(top * (1.0f - weight_y) + bottom * weight_y + 0.5f);
+      }
+    }
+  }
+  return resized;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,114 @@
+#include "texture_registry.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <climits>
+  #include <cstdlib>
+  #define TEXTURE_REGISTRY_REALPATH
+#endif
+
+// resolve relative parts and links, so different spellings of a path share the texture
+// files that can not be resolved are keyed by the path as given
+static std::string canonical_path(std::string const& path) {
+#ifdef TEXTURE_REGISTRY_REALPATH
+  char resolved[PATH_MAX];
+  if (realpath(path.c_str(), resolved) != nullptr) {
+    return resolved;
+  }
+#endif
+  return path;
+}
+
+TextureRegistry::TextureRegistry(TextureStreamer& streamer) :
+    m_streamer(streamer),
+    m_entries{},
+    m_handles{} {}
+
+TextureRegistry::~TextureRegistry() {
+  for (auto const& entry : m_entries) {
+    m_streamer.unload(entry.second.texture);
+  }
+}
+
+texture_object TextureRegistry::acquire(std::string const& fileName, std::array<std::uint8_t, 4> const& placeholder) {
+  key_t key{GL_TEXTURE_2D, canonical_path(fileName)};
+  texture_object texture{};
+
+  if (!addReference(key, texture)) {
+    texture = m_streamer.load(fileName, placeholder);
+    insert(key, texture);
+  }
+  return texture;
+}
+
+texture_object TextureRegistry::acquireCubeMap(std::vector<std::string> const& faceFiles) {
+  key_t key{GL_TEXTURE_CUBE_MAP, ""};
+  for (std::string const& face : faceFiles) {
+    key.second += canonical_path(face) + "\n";
+  }
+  texture_object texture{};
+
+  if (!addReference(key, texture)) {
+    texture = m_streamer.loadCubeMap(faceFiles);
+    insert(key, texture);
+  }
+  return texture;
+}
+
+texture_object TextureRegistry::acquireArray(std::vector<std::string> const& layerFiles, std::size_t width, std::size_t height) {
+  key_t key{GL_TEXTURE_2D_ARRAY, std::to_string(width) + "x" + std::to_string(height) + "\n"};
+  for (std::string const& layer : layerFiles) {
+    key.second += canonical_path(layer) + "\n";
+  }
+  texture_object texture{};
+
+  if (!addReference(key, texture)) {
+    texture = m_streamer.loadArray(layerFiles, width, height);
+    insert(key, texture);
+  }
+  return texture;
+}
+
+void TextureRegistry::release(texture_object const& texture) {
+  auto entry = m_entries.find(texture.handle);
+  if (entry == m_entries.end()) {
+    return;
+  }
+  if (--entry->second.references == 0) {
+    m_streamer.unload(entry->second.texture);
+    m_handles.erase(entry->second.key);
+    m_entries.erase(entry);
+  }
+}
+
+std::size_t TextureRegistry::getTextureCount() const {
+  return m_entries.size();
+}
+
+std::size_t TextureRegistry::getReferenceCount(texture_object const& texture) const {
+  auto entry = m_entries.find(texture.handle);
+  return entry == m_entries.end() ? 0 : entry->second.references;
+}
+
+std::size_t TextureRegistry::getMemoryUsage() const {
+  std::size_t bytes = 0;
+  for (auto const& entry : m_entries) {
+    bytes += m_streamer.getTextureBytes(entry.first);
+  }
+  return bytes;
+}
+
+bool TextureRegistry::addReference(key_t const& key, texture_object& texture) {
+  auto handle = m_handles.find(key);
+  if (handle == m_handles.end()) {
+    return false;
+  }
+  Entry& entry = m_entries.at(handle->second);
+  ++entry.references;
+  texture = entry.texture;
+  return true;
+}
+
+void TextureRegistry::insert(key_t const& key, texture_object const& texture) {
+  m_entries[texture.handle] = Entry{texture, 1, key};
+  m_handles[key] = texture.handle;
+}
@@ -0,0 +1,319 @@
+#include "texture_streamer.hpp"
+
+#include "texture_loader.hpp"
+#include "utils.hpp"
+
+#include <glbinding/gl/functions.h>
+// use gl definitions from glbinding
+using namespace gl;
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+// video memory of a decoded image, the mip levels of 2d textures add up to a third of the base level
+static std::size_t image_bytes(pixel_data const& image, bool isMipmapped) {
+  std::size_t components = image.channels == GL_RED ? 1 : image.channels == GL_RG ? 2 : image.channels == GL_RGB ? 3 : 4;
+  std::size_t bytes = image.width * image.height * components;
+  return isMipmapped ? bytes + bytes / 3 : bytes;
+}
+
+TextureStreamer::TextureStreamer(TaskScheduler& scheduler) :
+    m_scheduler(scheduler),
+    m_isCompressionSupported{false},
+    m_mutex{},
+    m_decoded{},
+    m_finished{},
+    m_pending{0},
+    m_decoding{0} {
+  // s3tc is an extension in core profiles, without it baked files are ignored and the sources decoded
+  GLint extensionCount = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+  for (GLint i = 0; i < extensionCount; ++i) {
+    char const* extension = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, GLuint(i)));
+    if (extension != nullptr && std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0) {
+      m_isCompressionSupported = true;
+    }
+  }
+}
+
+TextureStreamer::~TextureStreamer() {
+  // the tasks write into this object, so it must outlive them
+  std::unique_lock<std::mutex> lock{m_mutex};
+  m_decoded.wait(lock, [this]() {
+    return m_decoding == 0;
+  });
+  for (GLuint handle : m_unloaded) {
+    glDeleteTextures(1, &handle);
+  }
+}
+
+texture_object TextureStreamer::load(std::string const& fileName, std::array<std::uint8_t, 4> const& placeholder) {
+  pixel_data pixel{std::vector<std::uint8_t>(placeholder.begin(), placeholder.end()), GL_RGBA, GL_UNSIGNED_BYTE, 1, 1};
+  texture_object texture = utils::create_texture_object(pixel);
+
+  queueDecode(fileName, texture.handle, GL_TEXTURE_2D);
+  return texture;
+}
+
+texture_object TextureStreamer::loadCubeMap(std::vector<std::string> const& faceFiles) {
+  texture_object texture{};
+  texture.target = GL_TEXTURE_CUBE_MAP;
+  glGenTextures(1, &texture.handle);
+  glBindTexture(GL_TEXTURE_CUBE_MAP, texture.handle);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+  for (std::size_t i = 0; i < faceFiles.size(); ++i) {
+    queueDecode(faceFiles[i], texture.handle, GL_TEXTURE_CUBE_MAP_POSITIVE_X + unsigned(i));
+  }
+  return texture;
+}
+
+texture_object TextureStreamer::loadArray(std::vector<std::string> const& layerFiles, std::size_t width, std::size_t height,
+                                          std::array<std::uint8_t, 4> const& placeholder) {
+  texture_object texture{};
+  texture.target = GL_TEXTURE_2D_ARRAY;
+  glGenTextures(1, &texture.handle);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture.handle);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  if (uploadBakedArray(texture.handle, layerFiles, width, height)) {
+    return texture;
+  }
+  // one placeholder pixel per layer
+  std::vector<std::uint8_t> pixels;
+  for (std::size_t i = 0; i < layerFiles.size(); ++i) {
+    pixels.insert(pixels.end(), placeholder.begin(), placeholder.end());
+  }
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, GLsizei(layerFiles.size()), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  m_arrays[texture.handle] = ArrayLayers{width, height, std::vector<pixel_data>(layerFiles.size())};
+
+  for (std::size_t i = 0; i < layerFiles.size(); ++i) {
+    queueDecode(layerFiles[i], texture.handle, GL_TEXTURE_2D_ARRAY, i, width, height);
+  }
+  return texture;
+}
+
+void TextureStreamer::queueDecode(std::string const& fileName, GLuint handle, GLenum target, std::size_t layer,
+                                  std::size_t width, std::size_t height) {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    ++m_pending;
+    ++m_decoding;
+  }
+  ++m_queued[handle];
+  auto decode = [this, fileName, handle, target, layer, width, height]() {
+    Decoded image{handle, target, layer, pixel_data{}, nullptr, nullptr};
+    std::string bakedPath = texture_cache::cache_path(fileName);
+    try {
+      // baked layers of arrays are only used if all of them fit the array, which loadArray checked already
+      if (target != GL_TEXTURE_2D_ARRAY && m_isCompressionSupported && texture_cache::is_current(bakedPath, fileName)) {
+        try {
+          image.baked.reset(new MappedTexture{bakedPath});
+        }
+        catch (std::logic_error const& error) {
+          // is_current only reads the header, a truncated or corrupt file is caught here and the source decoded instead
+          std::cerr << error.what() << ", using " << fileName << " unbaked" << std::endl;
+        }
+      }
+      if (!image.baked) {
+        image.pixels = texture_loader::file(fileName, false);
+      }
+      if (target == GL_TEXTURE_2D_ARRAY && (image.pixels.width != width || image.pixels.height != height)) {
+        image.pixels = texture_loader::resize(image.pixels, width, height);
+      }
+    } catch (...) {
+      image.error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_finished.push_back(std::move(image));
+    --m_decoding;
+    // notify while locked, the destructor may otherwise return in between
+    m_decoded.notify_all();
+  };
+  // without workers the tasks would only run when the main thread waits, so decoding them now is as fast
+  if (m_scheduler.getWorkerCount() == 0) {
+    decode();
+  } else {
+    // never into the queue of the context thread, which would otherwise decode while waiting for a parallelFor
+    m_scheduler.submitBackground(decode);
+  }
+}
+
+std::size_t TextureStreamer::uploadFinished() {
+  std::vector<Decoded> finished;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    finished.swap(m_finished);
+    m_pending -= finished.size();
+  }
+  // render queue binds its textures to unit 0 each frame, so uploading there disturbs no other binding
+  glActiveTexture(GL_TEXTURE0);
+  std::exception_ptr error = nullptr;
+
+  for (Decoded& image : finished) {
+    auto queued = m_queued.find(image.handle);
+    bool isLast = --queued->second == 0;
+    if (isLast) {
+      m_queued.erase(queued);
+    }
+    // images of unloaded textures are dropped, the texture is deleted with its last one
+    if (m_unloaded.count(image.handle) > 0) {
+      if (isLast) {
+        glDeleteTextures(1, &image.handle);
+        m_unloaded.erase(image.handle);
+      }
+      continue;
+    }
+    // the other images are still uploaded, failed ones keep their placeholder
+    if (image.error) {
+      error = error ? error : image.error;
+    }
+    // layers wait for the rest of their array
+    if (image.target == GL_TEXTURE_2D_ARRAY) {
+      m_arrays.at(image.handle).layers[image.layer] = std::move(image.pixels);
+      if (isLast) {
+        uploadArray(image.handle);
+      }
+      continue;
+    }
+    if (image.error) {
+      continue;
+    }
+    bool isCubeFace = image.target != GL_TEXTURE_2D;
+    glBindTexture(isCubeFace ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, image.handle);
+
+    if (image.baked) {
+      utils::upload_texture_levels(image.target, *image.baked);
+      for (std::size_t level = 0; level < image.baked->getLevelCount(); ++level) {
+        m_textureBytes[image.handle] += image.baked->getLevelSize(level);
+      }
+    } else {
+      glTexImage2D(image.target, 0, image.pixels.channels, GLsizei(image.pixels.width), GLsizei(image.pixels.height), 0,
+                   image.pixels.channels, image.pixels.channel_type, image.pixels.ptr());
+      // cube maps are only sampled at their base level
+      if (!isCubeFace) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+      }
+      m_textureBytes[image.handle] += image_bytes(image.pixels, !isCubeFace);
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return finished.size();
+}
+
+void TextureStreamer::uploadArray(GLuint handle) {
+  ArrayLayers const& array = m_arrays.at(handle);
+  GLsizei width = GLsizei(array.width);
+  GLsizei height = GLsizei(array.height);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, handle);
+  // the array is only stored as rgba if one of its layers has alpha, the other layers get an opaque one
+  bool hasAlpha = false;
+  for (pixel_data const& pixels : array.layers) {
+    hasAlpha = hasAlpha || pixels.channels == GL_RGBA;
+  }
+  GLenum format = hasAlpha ? GL_RGBA : GL_RGB;
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, hasAlpha ? GL_RGBA8 : GL_RGB8, width, height, GLsizei(array.layers.size()), 0, format,
+               GL_UNSIGNED_BYTE, nullptr);
+  // rows of rgb layers are not padded to 4 bytes
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  for (std::size_t layer = 0; layer < array.layers.size(); ++layer) {
+    pixel_data const& pixels = array.layers[layer];
+    if (pixels.ptr() != nullptr) {
+      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, GLint(layer), width, height, 1, pixels.channels, pixels.channel_type, pixels.ptr());
+    }
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  std::size_t bytes = array.width * array.height * (hasAlpha ? 4 : 3) * array.layers.size();
+  m_textureBytes[handle] = bytes + bytes / 3;
+  m_arrays.erase(handle);
+}
+
+bool TextureStreamer::uploadBakedArray(GLuint handle, std::vector<std::string> const& layerFiles, std::size_t width, std::size_t height) {
+  if (!m_isCompressionSupported || layerFiles.empty()) {
+    return false;
+  }
+  std::vector<MappedTexture> layers;
+  layers.reserve(layerFiles.size());
+
+  for (std::string const& fileName : layerFiles) {
+    std::string bakedPath = texture_cache::cache_path(fileName);
+    if (!texture_cache::is_current(bakedPath, fileName)) {
+      return false;
+    }
+    try {
+      layers.emplace_back(bakedPath);
+    }
+    catch (std::logic_error const& error) {
+      std::cerr << error.what() << ", using " << fileName << " unbaked" << std::endl;
+      return false;
+    }
+    // the layers share the levels of the array, files baked without --array-size usually have another size
+    MappedTexture const& layer = layers.back();
+    if (layer.getWidth(0) != width || layer.getHeight(0) != height || layer.getFormat() != layers.front().getFormat() ||
+        layer.getLevelCount() != layers.front().getLevelCount()) {
+      return false;
+    }
+  }
+  MappedTexture const& first = layers.front();
+  GLsizei layerCount = GLsizei(layers.size());
+  std::size_t bytes = 0;
+  glBindTexture(GL_TEXTURE_2D_ARRAY, handle);
+
+  for (std::size_t level = 0; level < first.getLevelCount(); ++level) {
+    GLsizei levelWidth = GLsizei(first.getWidth(level));
+    GLsizei levelHeight = GLsizei(first.getHeight(level));
+    std::size_t levelSize = first.getLevelSize(level);
+    // allocate the level of all layers, then fill it with the blocks straight from the mapped files
+    glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, GLint(level), first.getFormat(), levelWidth, levelHeight, layerCount, 0,
+                           GLsizei(levelSize * layers.size()), nullptr);
+    for (std::size_t layer = 0; layer < layers.size(); ++layer) {
+      glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, GLint(level), 0, 0, GLint(layer), levelWidth, levelHeight, 1,
+                                first.getFormat(), GLsizei(levelSize), layers[layer].getLevelData(level));
+    }
+    bytes += levelSize * layers.size();
+  }
+  m_textureBytes[handle] = bytes;
+  return true;
+}
+
+void TextureStreamer::finish() {
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_decoded.wait(lock, [this]() {
+      return m_decoding == 0;
+    });
+  }
+  uploadFinished();
+}
+
+std::size_t TextureStreamer::getPendingCount() const {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_pending;
+}
+
+void TextureStreamer::unload(texture_object const& texture) {
+  m_textureBytes.erase(texture.handle);
+  m_arrays.erase(texture.handle);
+
+  if (m_queued.count(texture.handle) > 0) {
+    m_unloaded.insert(texture.handle);
+  } else {
+    glDeleteTextures(1, &texture.handle);
+  }
+}
+
+std::size_t TextureStreamer::getTextureBytes(GLuint handle) const {
+  auto bytes = m_textureBytes.find(handle);
+  return bytes == m_textureBytes.end() ? 0 : bytes->second;
+}
@@ -0,0 +1,127 @@
+#include "transform_store.hpp"
+#include "node.hpp"
+
+TransformStore::TransformStore() :
+    m_root{},
+    m_parents{},
+    m_localTransforms{},
+    m_worldTransforms{},
+    m_firstDirty{0},
+    m_needsRebuild{false} {}
+
+TransformStore::~TransformStore() {
+  clear();
+}
+
+void TransformStore::build(std::shared_ptr<Node> const& root) {
+  clear();
+  m_root = root;
+
+  if (root) {
+    insert(*root, -1);
+  }
+  m_worldTransforms.resize(m_localTransforms.size());
+  // all world transforms have to be calculated once
+  m_firstDirty = 0;
+  m_needsRebuild = false;
+}
+
+void TransformStore::clear() {
+  std::shared_ptr<Node> root = m_root.lock();
+
+  if (root) {
+    detach(*root);
+  }
+  m_root.reset();
+  m_parents.clear();
+  m_localTransforms.clear();
+  m_worldTransforms.clear();
+  m_firstDirty = 0;
+  m_needsRebuild = false;
+}
+
+void TransformStore::invalidate() {
+  m_needsRebuild = true;
+}
+
+std::size_t TransformStore::size() const {
+  return m_parents.size();
+}
+
+void TransformStore::insert(Node& node, int parent) {
+  // parents are always inserted before their children
+  int index = int(m_parents.size());
+  node.m_store = this;
+  node.m_storeIndex = std::size_t(index);
+
+  m_parents.push_back(parent);
+  m_localTransforms.push_back(node.m_localTransform);
+
+  for (auto& pair : node.m_children) {
+    insert(*pair.second, index);
+  }
+}
+
+void TransformStore::detach(Node& node) {
+  if (node.m_store != this) {
+    return;
+  }
+  node.m_store = nullptr;
+  // the cached transform of the node itself is outdated
+  node.m_isDirty = true;
+
+  for (auto& pair : node.m_children) {
+    detach(*pair.second);
+  }
+}
+
+glm::mat4 const& TransformStore::getLocalTransform(std::size_t index) const {
+  return m_localTransforms[index];
+}
+
+void TransformStore::setLocalTransform(std::size_t index, glm::mat4 const& transform) {
+  m_localTransforms[index] = transform;
+  // transforms before the index are not affected, children are always sorted behind their parent
+  std::size_t firstDirty = m_firstDirty;
+  while (index < firstDirty && !m_firstDirty.compare_exchange_weak(firstDirty, index)) {}
+}
+
+glm::mat4 const& TransformStore::getWorldTransform(std::size_t index) {
+  update();
+  return m_worldTransforms[index];
+}
+
+void TransformStore::setLocalTransform(Node const& node, glm::mat4 const& transform) {
+  // a rebuild copies the local transforms of all nodes anyway
+  if (!m_needsRebuild) {
+    setLocalTransform(node.m_storeIndex, transform);
+  }
+}
+
+glm::mat4 const& TransformStore::getWorldTransform(Node const& node) {
+  // update first, a rebuild may change the index of the node
+  update();
+  return m_worldTransforms[node.m_storeIndex];
+}
+
+void TransformStore::update() {
+  if (m_needsRebuild) {
+    build(m_root.lock());
+  }
+  std::size_t count = m_parents.size();
+  std::size_t firstDirty = m_firstDirty;
+
+  if (firstDirty >= count) {
+    return;
+  }
+  // root is the only transform without parent
+  if (firstDirty == 0) {
+    m_worldTransforms[0] = m_localTransforms[0];
+    firstDirty = 1;
+  }
+  // parents are sorted before their children, so their world transform is always up to date
+  for (std::size_t i = firstDirty; i < count; ++i) {
+    m_worldTransforms[i] = m_worldTransforms[m_parents[i]] * m_localTransforms[i];
+  }
+  m_firstDirty = count;
+}
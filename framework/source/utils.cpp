@@ -2,6 +2,10 @@
 
 #include "pixel_data.hpp"
 #include "structs.hpp"
+#include "model.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_processing.hpp"
+#include "texture_cache.hpp"
 
 #include <glbinding/gl/functions.h>
 // use gl definitions from glbinding 
@@ -22,8 +26,8 @@ texture_object create_texture_object(pixel_data const& tex) {
   glGenTextures(1, &t_obj.handle);
   glBindTexture(GL_TEXTURE_2D, t_obj.handle);
 
-  //sets interpolation for texture scaling to linear
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  //sets interpolation for texture scaling to linear, minified textures blend the two closest mip levels
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   //sets texture wrapping to repeat
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -31,10 +35,142 @@ texture_object create_texture_object(pixel_data const& tex) {
 
   //2d texture, no mip map, internal format on GPU, w, h, border 0, format of original image, it's data type, pointer to texture data
   glTexImage2D(GL_TEXTURE_2D, 0, tex.channels, (GLsizei) tex.width, (GLsizei) tex.height, 0, tex.channels, tex.channel_type, tex.ptr());
+  glGenerateMipmap(GL_TEXTURE_2D);
 
   return t_obj;
 }
 
+void upload_texture_levels(GLenum target, MappedTexture const& texture) {
+  for (std::size_t level = 0; level < texture.getLevelCount(); ++level) {
+    // the blocks go from the mapped file to the driver without being decoded
+    glCompressedTexImage2D(target, GLint(level), texture.getFormat(), GLsizei(texture.getWidth(level)),
+                           GLsizei(texture.getHeight(level)), 0, GLsizei(texture.getLevelSize(level)), texture.getLevelData(level));
+  }
+}
+
+texture_object create_texture_object(MappedTexture const& texture) {
+  texture_object t_obj{};
+
+  glGenTextures(1, &t_obj.handle);
+  glBindTexture(GL_TEXTURE_2D, t_obj.handle);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  upload_texture_levels(GL_TEXTURE_2D, texture);
+
+  return t_obj;
+}
+
+// upload interleaved vertices and indices, attributes are bound to their index in model::VERTEX_ATTRIBS
+// packed vertices use the formats of model::PACKED_VERTEX_ATTRIBS at the same locations
+static model_object upload_model_object(void const* vertices, std::size_t vertex_data_bytes, GLsizei vertex_bytes,
+                                        model::attrib_flag_t attributes, std::map<model::attrib_flag_t, GLvoid*> const& offsets,
+                                        void const* indices, std::size_t index_count, model::attribute const& index_format,
+                                        std::vector<model::lod> const& lods, GLenum draw_mode) {
+  model_object object{};
+
+  // generate vertex array object
+  glGenVertexArrays(1, &object.vertex_AO);
+  // bind the array for attaching buffers
+  glBindVertexArray(object.vertex_AO);
+
+  // generate generic buffer
+  glGenBuffers(1, &object.vertex_BO);
+  // bind this as a vertex array buffer containing all attributes
+  glBindBuffer(GL_ARRAY_BUFFER, object.vertex_BO);
+  // configure currently bound array buffer
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertex_data_bytes), vertices, GL_STATIC_DRAW);
+
+  std::vector<model::attribute> const& formats = model::vertex_attribs(attributes);
+  for (std::size_t i = 0; i < formats.size(); ++i) {
+    model::attribute const& attribute = formats[i];
+    auto offset = offsets.find(attribute);
+    // only bind attributes contained in the model
+    if (offset == offsets.end()) {
+      continue;
+    }
+    // attribute location is the index of the attribute
+    glEnableVertexAttribArray(GLuint(i));
+    glVertexAttribPointer(GLuint(i), attribute.components, attribute.type, attribute.normalized, vertex_bytes, offset->second);
+  }
+
+  // generate generic buffer
+  glGenBuffers(1, &object.element_BO);
+  // bind this as a vertex array buffer containing all attributes
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.element_BO);
+  // configure currently bound array buffer
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(std::size_t(index_format.size) * index_count), indices, GL_STATIC_DRAW);
+  object.index_type = index_format.type;
+
+  // store type of primitive to draw
+  object.draw_mode = draw_mode;
+  // transfer number of indices to model object, levels of detail after the full mesh are only drawn when selected
+  object.num_elements = GLsizei(lods.empty() ? index_count : lods.front().index_count);
+  object.lods = lods;
+
+  return object;
+}
+
+// copy the transforms restoring packed vertices into the object
+static void set_dequantization(model_object& object, mesh_processing::dequantization const& restore) {
+  object.position_offset = {{restore.offset[0], restore.offset[1], restore.offset[2]}};
+  object.position_scale = restore.scale;
+  object.texcoord_transform = {{restore.texcoord_offset[0], restore.texcoord_offset[1],
+                                restore.texcoord_scale[0], restore.texcoord_scale[1]}};
+}
+
+model_object create_model_object(model const& mdl, GLenum draw_mode, bool pack_vertices) {
+  model::attrib_flag_t attributes = 0;
+  for (auto const& pair : mdl.offsets) {
+    attributes |= pair.first;
+  }
+  void const* vertices = mdl.data.data();
+  std::size_t vertex_data_bytes = sizeof(float) * mdl.data.size();
+  GLsizei vertex_bytes = mdl.vertex_bytes;
+  std::map<model::attrib_flag_t, GLvoid*> offsets = mdl.offsets;
+  std::vector<char> packed;
+  mesh_processing::dequantization restore{};
+
+  if (pack_vertices && mesh_processing::pack_vertices(mdl, packed, restore)) {
+    attributes |= model::PACKED;
+    offsets.clear();
+    vertex_bytes = model::compute_offsets(attributes, offsets);
+    vertices = packed.data();
+    vertex_data_bytes = packed.size();
+  }
+  // models with few vertices are drawn with 16 bit indices
+  model::attribute const& index_format = model::index_format(mdl.vertex_num);
+  std::vector<GLushort> short_indices;
+  void const* indices = mdl.indices.data();
+  if (index_format.type == GL_UNSIGNED_SHORT) {
+    short_indices.assign(mdl.indices.begin(), mdl.indices.end());
+    indices = short_indices.data();
+  }
+  model_object object = upload_model_object(vertices, vertex_data_bytes, vertex_bytes, attributes, offsets,
+                                            indices, mdl.indices.size(), index_format, mdl.lods, draw_mode);
+  if (attributes & model::PACKED) {
+    set_dequantization(object, restore);
+  }
+  return object;
+}
+
+model_object create_model_object(MappedMesh const& mesh, GLenum draw_mode) {
+  // the mapped blocks are uploaded directly, without copying them into a model first
+  model_object object = upload_model_object(mesh.getVertices(), mesh.getVertexCount() * std::size_t(mesh.getVertexBytes()),
+                                            mesh.getVertexBytes(), mesh.getAttributes(), mesh.getOffsets(),
+                                            mesh.getIndices(), mesh.getIndexCount(), mesh.getIndexFormat(), mesh.getLods(),
+                                            draw_mode);
+  // packed positions are restored by the model matrix of the nodes drawing the object, texcoords by the shader
+  set_dequantization(object, mesh.getDequantization());
+  return object;
+}
+
+glm::fmat4 dequantization_matrix(model_object const& object) {
+  glm::fvec3 offset{object.position_offset[0], object.position_offset[1], object.position_offset[2]};
+  return glm::scale(glm::translate(glm::fmat4{}, offset), glm::fvec3{object.position_scale});
+}
+
 void print_bound_textures() {
   GLint id1, id2, id3, active_unit, texture_units = 0;
   glGetIntegerv(GL_ACTIVE_TEXTURE, &active_unit);
@@ -75,6 +211,23 @@ GLint glGetUniformLocation(GLuint program, const GLchar* name) {
   return loc;
 }
 
+void update_uniform_handles(shader_program& program) {
+  for (int i = 0; i < UNIFORM_COUNT; ++i) {
+    auto iter = program.u_locs.find(uniform_name(uniform_id(i)));
+    // uniforms not requested are skipped by the gl, as for inactive ones
+    program.u_handles[std::size_t(i)] = iter != program.u_locs.end() ? iter->second : -1;
+  }
+}
+
+void bind_uniform_block(GLuint program, GLchar const* name, GLuint binding) {
+  GLuint index = glGetUniformBlockIndex(program, name);
+
+  if (index != GL_INVALID_INDEX) {
+    // glsl 330 has no binding layout qualifier, so the binding point is set after linking
+    glUniformBlockBinding(program, index, binding);
+  }
+}
+
 void validate_program(GLuint program) {
   glValidateProgram(program);
   // check if validation was successfull
@@ -10,7 +10,17 @@ uniform sampler2D ColorTex;
 uniform sampler2D DepthTex;
 uniform sampler2D LightTex;
 uniform sampler2D NoiseTex;
-uniform float Time;
+
+// per frame camera and lighting data, one buffer shared by all programs
+layout(std140) uniform FrameData {
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    vec3 CameraPos;
+    float Time;
+    vec3 PointLightPos;
+    vec3 PointLightColor;
+    vec3 AmbientLight;
+};
 
 const float NEAR = 0.1;
 const float FAR = 10.0;
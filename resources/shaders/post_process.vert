@@ -3,9 +3,16 @@
 layout (location = 0) in vec2 inPos;
 layout (location = 1) in vec2 inTexCoords;
 
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
-uniform vec3 SunPos;
+// per frame camera and lighting data, one buffer shared by all programs
+layout(std140) uniform FrameData {
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    vec3 CameraPos;
+    float Time;
+    vec3 PointLightPos;
+    vec3 PointLightColor;
+    vec3 AmbientLight;
+};
 
 out vec2 TexCoords;
 out vec2 pass_SunPos;
@@ -14,7 +21,7 @@ void main() {
     gl_Position = vec4(inPos.x, inPos.y, 0.0, 1.0);
     TexCoords = inTexCoords;
 
-    vec4 sunGlPos = (ProjectionMatrix * ViewMatrix) * vec4(SunPos, 1.0);
+    vec4 sunGlPos = (ProjectionMatrix * ViewMatrix) * vec4(PointLightPos, 1.0);
     vec4 sunNdc = sunGlPos / sunGlPos.w;
     vec2 sunViewPortPos = sunNdc.xy * 0.5 + 0.5;
     pass_SunPos = sunViewPortPos;
@@ -10,33 +10,30 @@ in float pass_PointLightDist;
 in vec3 pass_ViewDir;
 in vec3 pass_AmbientLight;
 in vec2 pass_TexCoord;
+in vec3 pass_Tangent;
+in vec3 pass_Bitangent;
+flat in int pass_TextureLayer;
 
 layout(location = 0) out vec4 FragColor;
 layout(location = 1) out vec4 LightEmitColor;
 
-uniform sampler2D Tex;
+// images of all planets, selected by the layer of the node
+uniform sampler2DArray Tex;
 uniform sampler2D NormalMap;
 uniform bool IsCelEnabled;
 uniform bool IsNormalMapEnabled;
 
-vec3 perturbNormal(vec3 vertex_pos, vec3 surf_norm, vec2 uv) {
-    //derivatives in x and y direction of the geometry surface at the given vertex position
-    vec3 q0 = dFdx(vertex_pos.xyz);
-    vec3 q1 = dFdy(vertex_pos.xyz);
-
-    vec2 st0 = dFdx(uv.st);
-    vec2 st1 = dFdy(uv.st);
-
-    //calculate vector basis for tangent space
-    vec3 S = -normalize(q0 * st1.t - q1 * st0.t);
-    vec3 T = normalize(-q0 * st1.s + q1 * st0.s);
+vec3 perturbNormal(vec3 surf_norm, vec3 tangent, vec3 bitangent, vec2 uv) {
+    //vector basis of tangent space, precomputed per vertex by the model loader
+    vec3 T = normalize(tangent);
+    vec3 B = normalize(bitangent);
     vec3 N = normalize(surf_norm);
 
     //convert normal map in 0 to 1 range to vector range in -1 to 1
     vec3 mapN = texture2D(NormalMap, uv).xyz * 2.0 - 1.0;
 
     //rotation matrix to convert from tangent space to world space
-    mat3 tsn = mat3(S, T, N);
+    mat3 tsn = mat3(T, B, N);
     //return rotated normal vector
     return normalize(tsn * mapN);
 }
@@ -45,7 +42,7 @@ void main() {
     vec3 normal = pass_Normal;
 
     if (IsNormalMapEnabled) {
-        normal = perturbNormal(pass_VertexPos, pass_Normal, pass_TexCoord);
+        normal = perturbNormal(pass_Normal, pass_Tangent, pass_Bitangent, pass_TexCoord);
     }
     //amount of light hitting the surface based on the angle between the normal and the light direction
     float lambertian = max(dot(pass_PointLightDir, normal), 0.0);
@@ -58,7 +55,7 @@ void main() {
     float specular = pow(specAngle, 50.0);
 
     //vec3 planetColor = pass_Color;
-    vec3 planetColor = texture2D(Tex, pass_TexCoord).xyz;
+    vec3 planetColor = texture(Tex, vec3(pass_TexCoord, pass_TextureLayer)).xyz;
 
     if (IsCelEnabled) {
         specular = round(specular);
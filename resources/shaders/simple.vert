@@ -3,19 +3,30 @@
 layout(location = 0) in vec3 in_Position;
 layout(location = 1) in vec3 in_Normal;
 layout(location = 2) in vec2 in_TexCoord;
+layout(location = 3) in vec3 in_Tangent;
+layout(location = 4) in vec3 in_Bitangent;
+
+// per frame camera and lighting data, one buffer shared by all programs
+layout(std140) uniform FrameData {
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    vec3 CameraPos;
+    float Time;
+    vec3 PointLightPos;
+    vec3 PointLightColor;
+    vec3 AmbientLight;
+};
 
 //Matrix Uniforms as specified with glUniformMatrix4fv
 uniform mat4 ModelMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
 uniform mat4 NormalMatrix;
 uniform vec3 Color;
-uniform vec3 PointLightColor;
-uniform vec3 PointLightPos;
-uniform vec3 AmbientLight;
-uniform vec3 CameraPos;
 uniform bool IsCelEnabled;
 uniform bool IsNormalMapEnabled;
+// offset in xy and scale in zw restoring packed texcoords
+uniform vec4 TexCoordTransform;
+// layer of the array texture holding the image of the node
+uniform int TextureLayer;
 
 out vec3 pass_VertexPos;
 out vec3 pass_Normal;
@@ -26,6 +37,9 @@ out float pass_PointLightDist;
 out vec3 pass_ViewDir;
 out vec3 pass_AmbientLight;
 out vec2 pass_TexCoord;
+out vec3 pass_Tangent;
+out vec3 pass_Bitangent;
+flat out int pass_TextureLayer;
 
 void main(void)
 {
@@ -46,5 +60,9 @@ void main(void)
     pass_PointLightColor = PointLightColor;
     pass_AmbientLight = AmbientLight;
     pass_ViewDir = normalize(CameraPos - worldPos.xyz);
-	pass_TexCoord = in_TexCoord;
+	pass_TexCoord = TexCoordTransform.xy + in_TexCoord * TexCoordTransform.zw;
+    pass_TextureLayer = TextureLayer;
+    // tangent space for normal mapping, directions follow the model matrix
+    pass_Tangent = (ModelMatrix * vec4(in_Tangent, 0.0)).xyz;
+    pass_Bitangent = (ModelMatrix * vec4(in_Bitangent, 0.0)).xyz;
 }
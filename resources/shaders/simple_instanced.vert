@@ -0,0 +1,66 @@
+#version 330 core
+// vertex attributes of VAO
+layout(location = 0) in vec3 in_Position;
+layout(location = 1) in vec3 in_Normal;
+layout(location = 2) in vec2 in_TexCoord;
+layout(location = 3) in vec3 in_Tangent;
+layout(location = 4) in vec3 in_Bitangent;
+// per instance attributes of InstancedGeometryNode
+layout(location = 5) in mat4 in_ModelMatrix;
+layout(location = 9) in mat3 in_NormalMatrix;
+layout(location = 12) in vec3 in_Color;
+layout(location = 13) in int in_TextureLayer;
+
+// per frame camera and lighting data, one buffer shared by all programs
+layout(std140) uniform FrameData {
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    vec3 CameraPos;
+    float Time;
+    vec3 PointLightPos;
+    vec3 PointLightColor;
+    vec3 AmbientLight;
+};
+uniform bool IsCelEnabled;
+uniform bool IsNormalMapEnabled;
+// offset in xy and scale in zw restoring packed texcoords
+uniform vec4 TexCoordTransform;
+
+out vec3 pass_VertexPos;
+out vec3 pass_Normal;
+out vec3 pass_Color;
+out vec3 pass_PointLightColor;
+out vec3 pass_PointLightDir;
+out float pass_PointLightDist;
+out vec3 pass_ViewDir;
+out vec3 pass_AmbientLight;
+out vec2 pass_TexCoord;
+out vec3 pass_Tangent;
+out vec3 pass_Bitangent;
+flat out int pass_TextureLayer;
+
+void main(void)
+{
+	vec4 worldPos = in_ModelMatrix * vec4(in_Position, 1.0);
+    gl_Position = (ProjectionMatrix * ViewMatrix) * worldPos;
+    pass_VertexPos = worldPos.xyz;
+    pass_Normal = normalize(in_NormalMatrix * in_Normal);
+    pass_Color = in_Color;
+    
+    // calculate distances
+    vec3 lightDist = PointLightPos - worldPos.xyz;
+    pass_PointLightDist = length(lightDist);
+    //calculate normalized light direction
+    pass_PointLightDir = lightDist / pass_PointLightDist;
+    //square light distance for light falloff
+    pass_PointLightDist *= pass_PointLightDist;
+
+    pass_PointLightColor = PointLightColor;
+    pass_AmbientLight = AmbientLight;
+    pass_ViewDir = normalize(CameraPos - worldPos.xyz);
+	pass_TexCoord = TexCoordTransform.xy + in_TexCoord * TexCoordTransform.zw;
+    pass_TextureLayer = in_TextureLayer;
+    // tangent space for normal mapping, directions follow the model matrix
+    pass_Tangent = (in_ModelMatrix * vec4(in_Tangent, 0.0)).xyz;
+    pass_Bitangent = (in_ModelMatrix * vec4(in_Bitangent, 0.0)).xyz;
+}
@@ -3,9 +3,16 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
-uniform vec3 CameraPos;
+// per frame camera and lighting data, one buffer shared by all programs
+layout(std140) uniform FrameData {
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    vec3 CameraPos;
+    float Time;
+    vec3 PointLightPos;
+    vec3 PointLightColor;
+    vec3 AmbientLight;
+};
 
 void main() {
     //texture coordinates somehow need to be mirrored except along z axis
@@ -5,10 +5,19 @@ layout(location = 0) in vec3 in_Position;
 // glVertexAttribPointer mapped color  to second attribute 
 layout(location = 1) in vec3 in_Color;
 
+// per frame camera and lighting data, one buffer shared by all programs
+layout(std140) uniform FrameData {
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    vec3 CameraPos;
+    float Time;
+    vec3 PointLightPos;
+    vec3 PointLightColor;
+    vec3 AmbientLight;
+};
+
 //Matrix Uniforms uploaded with glUniform*
 uniform mat4 ModelMatrix;
-uniform mat4 ViewMatrix;
-uniform mat4 ProjectionMatrix;
 
 out vec3 pass_Color;
 